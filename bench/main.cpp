@@ -0,0 +1,675 @@
+#include <concurrent_unordered_map.h>
+#include <hazard_pointer.h>
+#include <mpmc_queue.h>
+#include <pool_allocator.h>
+#include <shared_ptr.h>
+#include <skip_list.h>
+
+#include "back_off.h"
+#include "ordered_list.h"
+#include "structures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+/*
+  Every benchmark runs a fixed read/write mix on each thread for a fixed time after a warm-up.
+  Throughput counts every operation, latency is sampled every sample_every operations so
+  the clock reads don't dominate the cheap operations. Results are printed as one JSON document.
+*/
+struct Config {
+    std::vector<std::size_t> threads{1, 2, 4};
+    std::chrono::milliseconds warmup{200};
+    std::chrono::milliseconds duration{1000};
+    std::size_t read_percentage = 90;
+    std::size_t num_of_keys = 1024;
+    std::size_t sample_every = 16;
+    bool pin_threads = true;
+    std::string filter{};
+    lu::numa_policy numa = lu::numa_policy::none;
+    lu::fence_policy fence = lu::fence_policy::symmetric;
+};
+
+/*
+  xorshift64*: a few instructions per number and no shared state, unlike rand().
+*/
+class FastRng {
+public:
+    explicit FastRng(std::uint64_t seed) noexcept
+        : state_(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+    std::uint64_t operator()() noexcept {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1Dull;
+    }
+
+    std::size_t below(std::size_t bound) noexcept {
+        return static_cast<std::size_t>(((*this)() >> 32) * bound >> 32);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+enum class Operation : std::uint8_t { read, insert, erase };
+
+/*
+  Reads take read_percentage of the operations, the rest is split evenly between inserts and erases,
+  so the size of the structures stays around its initial value.
+*/
+class OperationMix {
+public:
+    explicit OperationMix(std::size_t read_percentage) noexcept
+        : read_percentage_(std::min<std::size_t>(read_percentage, 100)) {}
+
+    Operation next(FastRng &rng) const noexcept {
+        auto value = rng.below(100);
+        if (value < read_percentage_) {
+            return Operation::read;
+        }
+        return (value - read_percentage_) & 1 ? Operation::erase : Operation::insert;
+    }
+
+private:
+    std::size_t read_percentage_;
+};
+
+struct Percentiles {
+    std::uint64_t p50{};
+    std::uint64_t p90{};
+    std::uint64_t p99{};
+    std::uint64_t p999{};
+    std::uint64_t max{};
+
+    static Percentiles from(std::vector<std::uint64_t> &samples) {
+        Percentiles result;
+        if (samples.empty()) {
+            return result;
+        }
+        std::sort(samples.begin(), samples.end());
+        auto at = [&samples](double quantile) {
+            auto index = static_cast<std::size_t>(quantile * static_cast<double>(samples.size() - 1));
+            return samples[index];
+        };
+        result.p50 = at(0.5);
+        result.p90 = at(0.9);
+        result.p99 = at(0.99);
+        result.p999 = at(0.999);
+        result.max = samples.back();
+        return result;
+    }
+};
+
+struct Result {
+    std::string name;
+    std::size_t num_of_threads{};
+    std::size_t read_percentage{};
+    std::uint64_t num_of_ops{};
+    double seconds{};
+    Percentiles latency{};
+    lu::reclamation_stats stats{};
+    std::string fence{};
+};
+
+inline void pin_thread(std::size_t index) {
+#if defined(__linux__)
+    auto num_of_cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % num_of_cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void) index;
+#endif
+}
+
+/*
+  Runs op(operation, rng) on num_of_threads threads. The threads start together, run the warm-up
+  without counting and then count operations until the measured interval ends.
+*/
+template<class Op>
+Result run(const Config &config, std::string name, std::size_t num_of_threads, Op &&op) {
+    enum class Phase : std::uint8_t { starting, warmup, measure, stop };
+
+    struct alignas(128) ThreadResult {
+        std::uint64_t num_of_ops{};
+        std::vector<std::uint64_t> samples{};
+    };
+
+    std::atomic<Phase> phase{Phase::starting};
+    std::atomic<std::size_t> num_of_ready{};
+    std::vector<ThreadResult> results(num_of_threads);
+    OperationMix mix(config.read_percentage);
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_of_threads);
+    for (std::size_t i = 0; i < num_of_threads; ++i) {
+        threads.emplace_back([&, i] {
+            if (config.pin_threads) {
+                pin_thread(i);
+            }
+            FastRng rng(i + 1);
+            auto &result = results[i];
+            result.samples.reserve(1 << 16);
+            num_of_ready.fetch_add(1, std::memory_order_release);
+            while (phase.load(std::memory_order_acquire) == Phase::starting) {
+                std::this_thread::yield();
+            }
+            while (phase.load(std::memory_order_relaxed) == Phase::warmup) {
+                op(mix.next(rng), rng);
+            }
+            std::size_t counter{};
+            while (phase.load(std::memory_order_relaxed) == Phase::measure) {
+                auto operation = mix.next(rng);
+                if (++counter == config.sample_every) [[unlikely]] {
+                    counter = 0;
+                    auto start = std::chrono::steady_clock::now();
+                    op(operation, rng);
+                    auto end = std::chrono::steady_clock::now();
+                    result.samples.push_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                } else {
+                    op(operation, rng);
+                }
+                ++result.num_of_ops;
+            }
+        });
+    }
+
+    while (num_of_ready.load(std::memory_order_acquire) != num_of_threads) {
+        std::this_thread::yield();
+    }
+    phase.store(Phase::warmup, std::memory_order_release);
+    std::this_thread::sleep_for(config.warmup);
+
+    auto begin = std::chrono::steady_clock::now();
+    phase.store(Phase::measure, std::memory_order_relaxed);
+    std::this_thread::sleep_for(config.duration);
+    phase.store(Phase::stop, std::memory_order_relaxed);
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    Result result;
+    result.name = std::move(name);
+    result.num_of_threads = num_of_threads;
+    result.read_percentage = config.read_percentage;
+    result.seconds = std::chrono::duration<double>(end - begin).count();
+    std::vector<std::uint64_t> samples;
+    for (auto &thread_result: results) {
+        result.num_of_ops += thread_result.num_of_ops;
+        samples.insert(samples.end(), thread_result.samples.begin(), thread_result.samples.end());
+    }
+    result.latency = Percentiles::from(samples);
+    return result;
+}
+
+/*
+  Stacks and queues have no pure reads, a read pops an element and pushes it back.
+*/
+template<class Stack>
+Result bench_stack(const Config &config, std::string name, std::size_t num_of_threads) {
+    Stack stack;
+    for (std::size_t i = 0; i < config.num_of_keys; ++i) {
+        stack.push(static_cast<int>(i));
+    }
+    return run(config, std::move(name), num_of_threads, [&stack](Operation operation, FastRng &rng) {
+        switch (operation) {
+            case Operation::read:
+                if (auto value = stack.pop()) {
+                    stack.push(*value);
+                }
+                break;
+            case Operation::insert:
+                stack.push(static_cast<int>(rng()));
+                break;
+            case Operation::erase:
+                stack.pop();
+                break;
+        }
+    });
+}
+
+template<class Queue>
+Result bench_queue(const Config &config, std::string name, std::size_t num_of_threads) {
+    Queue queue;
+    for (std::size_t i = 0; i < config.num_of_keys; ++i) {
+        queue.push(static_cast<int>(i));
+    }
+    return run(config, std::move(name), num_of_threads, [&queue](Operation operation, FastRng &rng) {
+        switch (operation) {
+            case Operation::read:
+                if (auto value = queue.pop()) {
+                    queue.push(*value);
+                }
+                break;
+            case Operation::insert:
+                queue.push(static_cast<int>(rng()));
+                break;
+            case Operation::erase:
+                queue.pop();
+                break;
+        }
+    });
+}
+
+template<class Set, class MakeValue>
+Result bench_set(const Config &config, std::string name, std::size_t num_of_threads, MakeValue make_value) {
+    Set set;
+    FastRng init_rng(0);
+    for (std::size_t i = 0; i < config.num_of_keys / 2; ++i) {
+        set.insert(make_value(static_cast<int>(init_rng.below(config.num_of_keys))));
+    }
+    auto num_of_keys = config.num_of_keys;
+    return run(config, std::move(name), num_of_threads,
+               [&set, num_of_keys, make_value](Operation operation, FastRng &rng) {
+                   auto key = static_cast<int>(rng.below(num_of_keys));
+                   switch (operation) {
+                       case Operation::read:
+                           set.find(key);
+                           break;
+                       case Operation::insert:
+                           set.insert(make_value(key));
+                           break;
+                       case Operation::erase:
+                           set.erase(key);
+                           break;
+                   }
+               });
+}
+
+template<class AtomicSharedPtr>
+Result bench_atomic_shared_ptr(const Config &config, std::string name, std::size_t num_of_threads) {
+    AtomicSharedPtr value;
+    value.store(lu::make_shared<int>(0));
+    return run(config, std::move(name), num_of_threads, [&value](Operation operation, FastRng &rng) {
+        if (operation == Operation::read) {
+            auto loaded = value.load();
+            if (!loaded) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            value.store(lu::make_shared<int>(static_cast<int>(rng())));
+        }
+    });
+}
+
+/*
+  Reads only borrow the current value, the reference count isn't touched.
+*/
+Result bench_load_guarded(const Config &config, std::string name, std::size_t num_of_threads) {
+    lu::atomic_shared_ptr<int> value;
+    value.store(lu::make_shared<int>(0));
+    return run(config, std::move(name), num_of_threads, [&value](Operation operation, FastRng &rng) {
+        if (operation == Operation::read) {
+            auto loaded = value.load_guarded();
+            if (!loaded) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            value.store(lu::make_shared<int>(static_cast<int>(rng())));
+        }
+    });
+}
+
+/*
+  Every thread copies its own pointer, writes replace it with a fresh one.
+*/
+template<bool IsBiased>
+Result bench_shared_ptr_copy(const Config &config, std::string name, std::size_t num_of_threads) {
+    auto make = [](int value) {
+        if constexpr (IsBiased) {
+            return lu::make_shared_biased<int>(value);
+        } else {
+            return lu::make_shared<int>(value);
+        }
+    };
+    std::vector<lu::shared_ptr<int>> owned(num_of_threads);
+    std::atomic<std::size_t> num_of_owners{};
+    return run(config, std::move(name), num_of_threads, [&](Operation operation, FastRng &rng) {
+        thread_local lu::shared_ptr<int> *mine{};
+        if (!mine) [[unlikely]] {
+            mine = &owned[num_of_owners.fetch_add(1, std::memory_order_relaxed)];
+            *mine = make(0);
+        }
+        if (operation == Operation::read) {
+            auto copy = *mine;
+            if (!copy) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            *mine = make(static_cast<int>(rng()));
+        }
+    });
+}
+
+/*
+  Same as bench_atomic_shared_ptr, but the control blocks come from Allocator. They are freed by the scans,
+  mostly on other threads than the one that allocated them.
+*/
+template<template<class> class Allocator>
+Result bench_alloc_shared(const Config &config, std::string name, std::size_t num_of_threads) {
+    lu::atomic_shared_ptr<int> value;
+    value.store(lu::alloc_shared<int>(Allocator<int>{}, 0));
+    return run(config, std::move(name), num_of_threads, [&value](Operation operation, FastRng &rng) {
+        if (operation == Operation::read) {
+            auto loaded = value.load();
+            if (!loaded) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            value.store(lu::alloc_shared<int>(Allocator<int>{}, static_cast<int>(rng())));
+        }
+    });
+}
+
+struct RawNode : lu::hazard_pointer_obj_base<RawNode> {
+    std::uint64_t value{};
+    std::atomic<RawNode *> next{};
+};
+
+/*
+  Reads protect the current node and touch it, writes swap in a new node and retire the old one.
+*/
+Result bench_hazard_pointer(const Config &config, std::string name, std::size_t num_of_threads,
+                            lu::hazard_pointer_domain &domain = lu::get_default_domain()) {
+    std::atomic<RawNode *> current{new RawNode()};
+    auto op = [&current, &domain](Operation operation, FastRng &rng) {
+        if (operation == Operation::read) {
+            auto guard = lu::make_hazard_pointer(domain);
+            auto node = guard.protect(current);
+            if (node->value == ~std::uint64_t{}) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            auto node = new RawNode();
+            node->value = rng() >> 1;
+            current.exchange(node, std::memory_order_acq_rel)->retire({}, domain);
+        }
+    };
+    auto result = run(config, std::move(name), num_of_threads, op);
+    current.load()->retire({}, domain);
+    return result;
+}
+
+/*
+  Reads walk a sorted chain of num_of_keys / 2 nodes up to a random key hand over hand, protecting
+  every node they step on like OrderedList::find does. The chain never changes, writes swap and retire
+  a node aside of it as above, so the scans they run have to go past the guards of the readers.
+*/
+Result bench_hazard_pointer_chain(const Config &config, std::string name, std::size_t num_of_threads,
+                                  lu::hazard_pointer_domain &domain = lu::get_default_domain()) {
+    std::atomic<RawNode *> head{};
+    for (auto i = config.num_of_keys / 2; i-- > 0;) {
+        auto node = new RawNode();
+        node->value = i * 2;
+        node->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        head.store(node, std::memory_order_relaxed);
+    }
+    std::atomic<RawNode *> current{new RawNode()};
+    auto num_of_keys = config.num_of_keys;
+    auto op = [&head, &current, &domain, num_of_keys](Operation operation, FastRng &rng) {
+        if (operation == Operation::read) {
+            auto key = rng.below(num_of_keys);
+            auto cur_guard = lu::make_hazard_pointer(domain);
+            auto next_guard = lu::make_hazard_pointer(domain);
+            auto node = cur_guard.protect(head);
+            while (node && node->value < key) {
+                node = next_guard.protect(node->next);
+                cur_guard.swap(next_guard);
+            }
+            if (node && node->value == ~std::uint64_t{}) [[unlikely]] {
+                std::abort();
+            }
+        } else {
+            auto node = new RawNode();
+            node->value = rng() >> 1;
+            current.exchange(node, std::memory_order_acq_rel)->retire({}, domain);
+        }
+    };
+    auto result = run(config, std::move(name), num_of_threads, op);
+    current.load()->retire({}, domain);
+    for (auto node = head.load(); node;) {
+        delete std::exchange(node, node->next.load());
+    }
+    return result;
+}
+
+const char *fence_name(lu::fence_policy fence) {
+    return fence == lu::fence_policy::asymmetric ? "asymmetric" : "symmetric";
+}
+
+/*
+  Runs one of the benchmarks above over a domain of its own with the NUMA and fence policies of the run.
+  The stats count how many of the records the scans read belong to threads of another node, the fence
+  is the one the domain ended up with: asymmetric falls back to symmetric where the kernel can't do it.
+*/
+template<class Bench>
+Result bench_on_domain(const Config &config, std::string name, std::size_t num_of_threads, Bench bench) {
+    lu::reclamation_stats stats{};
+    lu::fence_policy fence{};
+    Result result;
+    {
+        lu::hazard_pointer_domain domain(lu::DEFAULT_NUM_OF_RECORDS, lu::DEFAULT_NUM_OF_RETIRES,
+                                         lu::DEFAULT_SCAN_THRESHOLD, config.fence, lu::threshold_policy::fixed,
+                                         lu::layout_policy::compact, config.numa);
+        result = bench(config, std::move(name), num_of_threads, domain);
+        domain.cleanup();
+        stats = domain.get_stats();
+        fence = domain.get_fence_policy();
+        domain.detach_thread();
+    }
+    result.stats = stats;
+    result.fence = fence_name(fence);
+    return result;
+}
+
+const char *numa_name(lu::numa_policy numa) {
+    switch (numa) {
+        case lu::numa_policy::local:
+            return "local";
+        case lu::numa_policy::hierarchical:
+            return "hierarchical";
+        default:
+            return "none";
+    }
+}
+
+void print_json(const Config &config, const std::vector<Result> &results) {
+    std::cout << "{\n";
+    std::cout << "  \"config\": {\"warmup_ms\": " << config.warmup.count()
+              << ", \"duration_ms\": " << config.duration.count() << ", \"num_of_keys\": " << config.num_of_keys
+              << ", \"sample_every\": " << config.sample_every
+              << ", \"pin_threads\": " << (config.pin_threads ? "true" : "false")
+              << ", \"numa\": \"" << numa_name(config.numa) << "\""
+              << ", \"fence\": \"" << fence_name(config.fence) << "\""
+              << ", \"hardware_concurrency\": " << std::thread::hardware_concurrency() << "},\n";
+    std::cout << "  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        auto &result = results[i];
+        auto ops_per_sec = result.seconds > 0 ? static_cast<double>(result.num_of_ops) / result.seconds : 0.0;
+        std::cout << (i ? ",\n" : "\n");
+        std::cout << "    {\"name\": \"" << result.name << "\", \"threads\": " << result.num_of_threads
+                  << ", \"read_percentage\": " << result.read_percentage << ", \"ops\": " << result.num_of_ops
+                  << ", \"seconds\": " << result.seconds
+                  << ", \"ops_per_sec\": " << static_cast<std::uint64_t>(ops_per_sec)
+                  << ", \"latency_ns\": {\"p50\": " << result.latency.p50 << ", \"p90\": " << result.latency.p90
+                  << ", \"p99\": " << result.latency.p99 << ", \"p999\": " << result.latency.p999
+                  << ", \"max\": " << result.latency.max << "}";
+        if (result.stats.num_of_scans) {
+            std::cout << ", \"scans\": " << result.stats.num_of_scans
+                      << ", \"inspected_records\": " << result.stats.num_of_inspected_records
+                      << ", \"remote_records\": " << result.stats.num_of_remote_records;
+        }
+        if (!result.fence.empty()) {
+            std::cout << ", \"fence\": \"" << result.fence << "\"";
+        }
+        std::cout << "}";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+}
+
+std::vector<std::size_t> parse_list(std::string_view value) {
+    std::vector<std::size_t> result;
+    while (!value.empty()) {
+        auto comma = value.find(',');
+        result.push_back(std::stoul(std::string(value.substr(0, comma))));
+        value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+    }
+    return result;
+}
+
+lu::numa_policy parse_numa(std::string_view value) {
+    if (value == "local") {
+        return lu::numa_policy::local;
+    }
+    if (value == "hierarchical") {
+        return lu::numa_policy::hierarchical;
+    }
+    return lu::numa_policy::none;
+}
+
+lu::fence_policy parse_fence(std::string_view value) {
+    return value == "asymmetric" ? lu::fence_policy::asymmetric : lu::fence_policy::symmetric;
+}
+
+Config parse_config(int argc, char **argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        auto equal = arg.find('=');
+        auto key = arg.substr(0, equal);
+        auto value = equal == std::string_view::npos ? std::string_view{} : arg.substr(equal + 1);
+        if (key == "--threads") {
+            config.threads = parse_list(value);
+        } else if (key == "--warmup-ms") {
+            config.warmup = std::chrono::milliseconds(std::stoul(std::string(value)));
+        } else if (key == "--duration-ms") {
+            config.duration = std::chrono::milliseconds(std::stoul(std::string(value)));
+        } else if (key == "--reads") {
+            config.read_percentage = std::stoul(std::string(value));
+        } else if (key == "--keys") {
+            config.num_of_keys = std::max<std::size_t>(1, std::stoul(std::string(value)));
+        } else if (key == "--sample-every") {
+            config.sample_every = std::max<std::size_t>(1, std::stoul(std::string(value)));
+        } else if (key == "--no-pin") {
+            config.pin_threads = false;
+        } else if (key == "--numa") {
+            config.numa = parse_numa(value);
+        } else if (key == "--fence") {
+            config.fence = parse_fence(value);
+        } else if (key == "--filter") {
+            config.filter = std::string(value);
+        } else {
+            std::cerr << "usage: bench [--threads=1,2,4] [--warmup-ms=N] [--duration-ms=N] [--reads=PERCENT]"
+                         " [--keys=N] [--sample-every=N] [--no-pin] [--numa=none|local|hierarchical]"
+                         " [--fence=symmetric|asymmetric] [--filter=SUBSTRING]"
+                      << std::endl;
+            std::exit(arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    return config;
+}
+
+int main(int argc, char **argv) {
+    using back_off = lu::none_backoff;
+    using exp_back_off = lu::exponential_backoff<>;
+    using set_type = lu::ordered_list_set<int>;
+    using map_type = lu::ordered_list_map<int, int>;
+    using hash_set_type = lu::concurrent_unordered_set<int>;
+    using hash_map_type = lu::concurrent_unordered_map<int, int>;
+    using skip_set_type = lu::skip_list_set<int>;
+    using skip_map_type = lu::skip_list_map<int, int>;
+
+    auto config = parse_config(argc, argv);
+
+    using bench_func = std::function<Result(const Config &, std::string, std::size_t)>;
+    std::vector<std::pair<std::string, bench_func>> benchmarks{
+            {"hp_treiber_stack", bench_stack<lu::hp::TreiberStack<int, back_off>>},
+            {"hp_treiber_stack_yield", bench_stack<lu::hp::TreiberStack<int, lu::yield_backoff>>},
+            {"hp_treiber_stack_exp_backoff", bench_stack<lu::hp::TreiberStack<int, exp_back_off>>},
+            {"hp_treiber_stack_elimination", bench_stack<lu::hp::TreiberStack<int, exp_back_off, 8>>},
+            {"hp_ms_queue", bench_queue<lu::hp::MSQueue<int, back_off>>},
+            {"mpmc_queue", bench_queue<lu::mpmc_queue<int>>},
+            {"ordered_list_set",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<set_type>(config, std::move(name), num_of_threads, [](int key) { return key; });
+             }},
+            {"ordered_list_map",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<map_type>(config, std::move(name), num_of_threads,
+                                            [](int key) { return std::pair<const int, int>(key, key); });
+             }},
+            {"concurrent_unordered_set",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<hash_set_type>(config, std::move(name), num_of_threads, [](int key) { return key; });
+             }},
+            {"concurrent_unordered_map",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<hash_map_type>(config, std::move(name), num_of_threads,
+                                                 [](int key) { return std::pair<const int, int>(key, key); });
+             }},
+            {"skip_list_set",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<skip_set_type>(config, std::move(name), num_of_threads, [](int key) { return key; });
+             }},
+            {"skip_list_map",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_set<skip_map_type>(config, std::move(name), num_of_threads,
+                                                 [](int key) { return std::pair<const int, int>(key, key); });
+             }},
+            {"atomic_shared_ptr", bench_atomic_shared_ptr<lu::atomic_shared_ptr<int>>},
+            {"split_atomic_shared_ptr", bench_atomic_shared_ptr<lu::split_atomic_shared_ptr<int>>},
+            {"atomic_shared_ptr_load_guarded", bench_load_guarded},
+            {"shared_ptr_copy", bench_shared_ptr_copy<false>},
+            {"shared_ptr_copy_biased", bench_shared_ptr_copy<true>},
+            {"alloc_shared", bench_alloc_shared<std::allocator>},
+            {"alloc_shared_pool", bench_alloc_shared<lu::pool_allocator>},
+            {"hazard_pointer",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_hazard_pointer(config, std::move(name), num_of_threads);
+             }},
+            {"hazard_pointer_numa",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_on_domain(config, std::move(name), num_of_threads, bench_hazard_pointer);
+             }},
+            {"hazard_pointer_chain",
+             [](const Config &config, std::string name, std::size_t num_of_threads) {
+                 return bench_on_domain(config, std::move(name), num_of_threads, bench_hazard_pointer_chain);
+             }},
+    };
+
+    std::vector<Result> results;
+    for (auto &[name, bench]: benchmarks) {
+        if (!config.filter.empty() && name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        for (auto num_of_threads: config.threads) {
+            results.push_back(bench(config, name, num_of_threads));
+        }
+    }
+    print_json(config, results);
+}
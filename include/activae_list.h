@@ -10,6 +10,8 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
 #include <utility>
@@ -36,17 +38,37 @@ struct ActiveListAlgo {
         node_traits::store_active(this_node, false, std::memory_order_release);
     }
 
-    static node_ptr find_free(std::atomic<node_ptr> &head) {
-        node_ptr current = head.load(std::memory_order_acquire);
-        while (current) {
+    /*
+      Released nodes are also kept in a stack next to the list, so a free node is found without walking the
+      list. The top of the stack carries a tag in its upper bits against ABA, nodes are never freed while
+      the list is alive. A node that is popped but held by someone else for a moment (e.g. a help_scan())
+      is put back.
+    */
+    static node_ptr find_free(std::atomic<std::uint64_t> &free_head) {
+        node_ptr busy_head{};
+        node_ptr busy_tail{};
+        node_ptr current;
+        while ((current = pop_free(free_head))) {
             if (try_acquire(current)) {
                 break;
             }
-            current = node_traits::get_next(current);
+            node_traits::set_free_next(current, busy_head);
+            if (!busy_head) {
+                busy_tail = current;
+            }
+            busy_head = current;
+        }
+        if (busy_head) {
+            push_free(free_head, busy_head, busy_tail);
         }
         return current;
     }
 
+    static void release(std::atomic<std::uint64_t> &free_head, node_ptr this_node) {
+        release(this_node);
+        push_free(free_head, this_node, this_node);
+    }
+
     static void push_front(std::atomic<node_ptr> &head, node_ptr new_node) {
         node_traits::exchange_active(new_node, true, std::memory_order_acquire);
         node_ptr current = head.load(std::memory_order_relaxed);
@@ -54,6 +76,44 @@ struct ActiveListAlgo {
             node_traits::set_next(new_node, current);
         } while (!head.compare_exchange_weak(current, new_node, std::memory_order_release, std::memory_order_relaxed));
     }
+
+private:
+    static constexpr std::size_t TAG_SHIFT = sizeof(std::uintptr_t) == sizeof(std::uint64_t) ? 48 : 32;
+    static constexpr std::uint64_t POINTER_MASK = (std::uint64_t{1} << TAG_SHIFT) - 1;
+    static constexpr std::uint64_t ONE_TAG = std::uint64_t{1} << TAG_SHIFT;
+
+    static std::uint64_t to_bits(node_ptr node, std::uint64_t tag) noexcept {
+        auto bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(std::to_address(node)));
+        assert(!(bits & ~POINTER_MASK) && "Pointer uses the bits of the tag");
+        return bits | (tag & ~POINTER_MASK);
+    }
+
+    static node_ptr to_pointer(std::uint64_t bits) noexcept {
+        return node_traits::to_node_ptr(reinterpret_cast<typename node_traits::node *>(bits & POINTER_MASK));
+    }
+
+    static void push_free(std::atomic<std::uint64_t> &free_head, node_ptr first, node_ptr last) {
+        auto head = free_head.load(std::memory_order_relaxed);
+        do {
+            node_traits::set_free_next(last, to_pointer(head));
+        } while (!free_head.compare_exchange_weak(head, to_bits(first, head + ONE_TAG), std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+
+    static node_ptr pop_free(std::atomic<std::uint64_t> &free_head) {
+        auto head = free_head.load(std::memory_order_acquire);
+        while (true) {
+            auto current = to_pointer(head);
+            if (!current) {
+                return {};
+            }
+            auto next = node_traits::get_free_next(current);
+            if (free_head.compare_exchange_weak(head, to_bits(next, head + ONE_TAG), std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                return current;
+            }
+        }
+    }
 };
 
 template<class VoidPointer>
@@ -65,6 +125,7 @@ class ActiveListNode {
     using const_pointer = typename std::pointer_traits<pointer>::template rebind<const ActiveListNode>;
 
     pointer next{};
+    std::atomic<ActiveListNode *> free_next{};
     std::atomic<bool> is_active{};
 };
 
@@ -82,6 +143,18 @@ struct ActiveListNodeTraits {
         this_node->next = next;
     }
 
+    static node_ptr get_free_next(const_node_ptr this_node) {
+        return to_node_ptr(this_node->free_next.load(std::memory_order_relaxed));
+    }
+
+    static void set_free_next(node_ptr this_node, node_ptr next) {
+        this_node->free_next.store(next ? std::to_address(next) : nullptr, std::memory_order_relaxed);
+    }
+
+    static node_ptr to_node_ptr(node *this_node) {
+        return this_node ? std::pointer_traits<node_ptr>::pointer_to(*this_node) : node_ptr{};
+    }
+
     static bool exchange_active(node_ptr this_node, bool value, std::memory_order order) {
         return this_node->is_active.exchange(value, order);
     }
@@ -262,9 +335,12 @@ public:
         return Algo::is_acquired(_value_traits.to_node_ptr(item), order);
     }
 
+    /*
+      Releases the item and makes it the next one find_free() returns.
+    */
     void release(reference item) {
         const value_traits &_value_traits = GetValueTraits();
-        Algo::release(_value_traits.to_node_ptr(item));
+        Algo::release(free_head_, _value_traits.to_node_ptr(item));
     }
 
     void push(reference new_element) {
@@ -273,7 +349,7 @@ public:
     }
 
     iterator find_free() {
-        auto found = Algo::find_free(head_);
+        auto found = Algo::find_free(free_head_);
         return iterator(found, GetValueTraitsPtr());
     }
 
@@ -305,6 +381,7 @@ public:
 
 private:
     std::atomic<node_ptr> head_{};
+    std::atomic<std::uint64_t> free_head_{};
 };
 
 struct DefaultActiveListHookApplier {
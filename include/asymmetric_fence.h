@@ -0,0 +1,146 @@
+#ifndef __ASYMMETRIC_FENCE_H__
+#define __ASYMMETRIC_FENCE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace lu {
+namespace detail {
+
+/*
+  Asymmetric fences split a pair of seq_cst fences into a cheap side and an expensive side.
+  The light fence only forbids compiler reordering, the heavy fence forces every running thread
+  of the process through a full memory barrier, so a light/heavy pair gives the same guarantees
+  as two std::atomic_thread_fence(std::memory_order_seq_cst).
+*/
+class AsymmetricFence {
+#if defined(__linux__)
+    class MembarrierFence {
+    public:
+        MembarrierFence() noexcept {
+            long commands = ::syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+            if (commands < 0 || !(commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+                return;
+            }
+            supported_ = ::syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+        }
+
+        bool is_supported() const noexcept {
+            return supported_;
+        }
+
+        void operator()() const noexcept {
+            ::syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+        }
+
+    private:
+        bool supported_{false};
+    };
+
+    /*
+      Fallback for kernels without membarrier: downgrading the protection of a dirty page forces
+      the kernel to shoot down the TLB entries on every core running a thread of this process,
+      and the IPIs it sends serialize those cores.
+    */
+    class MprotectFence {
+    public:
+        MprotectFence() noexcept = default;
+
+        ~MprotectFence() {
+            if (page_) {
+                ::munlock(page_, page_size_);
+                ::munmap(page_, page_size_);
+            }
+        }
+
+        bool init() noexcept {
+            page_size_ = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            void *page = ::mmap(nullptr, page_size_, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (page == MAP_FAILED) {
+                return false;
+            }
+            ::mlock(page, page_size_);
+            page_ = static_cast<int *>(page);
+            return true;
+        }
+
+        void operator()() noexcept {
+            std::lock_guard lock(mutex_);
+            ::mprotect(page_, page_size_, PROT_READ | PROT_WRITE);
+            __atomic_add_fetch(page_, 1, __ATOMIC_SEQ_CST);
+            ::mprotect(page_, page_size_, PROT_READ);
+        }
+
+    private:
+        std::mutex mutex_{};
+        int *page_{};
+        std::size_t page_size_{};
+    };
+
+    AsymmetricFence() noexcept {
+        if (membarrier_.is_supported()) {
+            mode_ = Mode::membarrier;
+        } else if (mprotect_.init()) {
+            mode_ = Mode::mprotect;
+        }
+    }
+#else
+    AsymmetricFence() noexcept = default;
+#endif
+
+    enum class Mode : std::uint8_t { none, membarrier, mprotect };
+
+    static AsymmetricFence &get_instance() {
+        static AsymmetricFence fence;
+        return fence;
+    }
+
+public:
+    static bool is_supported() {
+        return get_instance().mode_ != Mode::none;
+    }
+
+    static inline void light() noexcept {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    static void heavy() {
+        auto &fence = get_instance();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        switch (fence.mode_) {
+#if defined(__linux__)
+            case Mode::membarrier:
+                fence.membarrier_();
+                break;
+            case Mode::mprotect:
+                fence.mprotect_();
+                break;
+#endif
+            default:
+                break;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+private:
+#if defined(__linux__)
+    MembarrierFence membarrier_{};
+    MprotectFence mprotect_{};
+#endif
+    Mode mode_{Mode::none};
+};
+
+}// namespace detail
+}// namespace lu
+
+#endif
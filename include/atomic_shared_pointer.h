@@ -4,17 +4,103 @@
 #include "hazard_pointer.h"
 
 #include <atomic>
+#include <utility>
 
 
 namespace lu {
 namespace detail {
 
+/*
+  Borrowed view of the value of an atomic reference counted pointer. The control block is protected
+  by a hazard pointer instead of a reference, so the value stays alive while the snapshot is held
+  without touching the reference count. upgrade() takes a reference for callers that need to
+  keep the value, it's empty when the last owner has gone meanwhile.
+*/
+template<class RefCountTraits>
+class SnapshotPointer {
+    using control_block_ptr = typename RefCountTraits::control_block_ptr;
+    using ref_count_ptr = typename RefCountTraits::ref_count_ptr;
+
+public:
+    using element_type = typename ref_count_ptr::element_type;
+    using pointer = element_type *;
+    using reference = element_type &;
+
+public:
+    SnapshotPointer() = default;
+
+    SnapshotPointer(lu::hazard_pointer guard, control_block_ptr control_block) noexcept
+        : guard_(std::move(guard))
+        , control_block_(control_block)
+        , ptr_(control_block ? reinterpret_cast<pointer>(control_block->get()) : nullptr) {}
+
+    SnapshotPointer(const SnapshotPointer &) = delete;
+
+    SnapshotPointer(SnapshotPointer &&other) noexcept
+        : guard_(std::move(other.guard_))
+        , control_block_(std::exchange(other.control_block_, {}))
+        , ptr_(std::exchange(other.ptr_, {})) {}
+
+    SnapshotPointer &operator=(const SnapshotPointer &) = delete;
+
+    SnapshotPointer &operator=(SnapshotPointer &&other) noexcept {
+        SnapshotPointer temp(std::move(other));
+        swap(temp);
+        return *this;
+    }
+
+    pointer get() const noexcept {
+        return ptr_;
+    }
+
+    pointer operator->() const noexcept {
+        return ptr_;
+    }
+
+    reference operator*() const noexcept {
+        return *ptr_;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr_;
+    }
+
+    ref_count_ptr upgrade() const noexcept {
+        if (control_block_ && RefCountTraits::inc_ref_if_not_zero(control_block_)) {
+            return RefCountTraits::create_ptr(control_block_);
+        }
+        return {};
+    }
+
+    void reset() noexcept {
+        SnapshotPointer temp;
+        swap(temp);
+    }
+
+    void swap(SnapshotPointer &other) noexcept {
+        guard_.swap(other.guard_);
+        std::swap(control_block_, other.control_block_);
+        std::swap(ptr_, other.ptr_);
+    }
+
+    friend void swap(SnapshotPointer &left, SnapshotPointer &right) noexcept {
+        left.swap(right);
+    }
+
+private:
+    lu::hazard_pointer guard_{};
+    control_block_ptr control_block_{};
+    pointer ptr_{};
+};
+
 template<class RefCountTraits>
 class AtomicRefCountPointer {
     using control_block_ptr = typename RefCountTraits::control_block_ptr;
     using ref_count_ptr = typename RefCountTraits::ref_count_ptr;
 
 public:
+    using snapshot_ptr = SnapshotPointer<RefCountTraits>;
+
     static constexpr bool is_always_lock_free = true;
 
 private:
@@ -75,6 +161,15 @@ public:
         return {};
     }
 
+    /*
+      Like load(), but the current value is only protected, the reference count isn't touched.
+    */
+    snapshot_ptr load_guarded() const noexcept {
+        lu::hazard_pointer guard = lu::make_hazard_pointer();
+        auto ptr = guard.protect(control_block_);
+        return snapshot_ptr(std::move(guard), ptr);
+    }
+
     ref_count_ptr exchange(ref_count_ptr desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
         auto desired_ptr = RefCountTraits::release_ptr(desired);
         auto old_ptr = control_block_.exchange(desired_ptr, order);
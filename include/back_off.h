@@ -1,10 +1,35 @@
 #ifndef __BACK_OF_H__
 #define __BACK_OF_H__
 
+#include <cstddef>
+#include <cstdint>
 #include <thread>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
 
 namespace lu {
+namespace detail {
+
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+inline std::uint32_t get_backoff_random() noexcept {
+    static thread_local std::uint32_t state = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&state)) | 1;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+}// namespace detail
 
 struct none_backoff {
     void operator()() const {}
@@ -16,6 +41,33 @@ struct yield_backoff {
     }
 };
 
+/*
+  Spins with pause for a random number of iterations between half the limit and the limit, the limit
+  doubles after every call up to MaxSpins, after that it yields. The jitter keeps threads that failed
+  on the same CAS from coming back at the same time. Holds state, a new one is made per operation.
+*/
+template<std::size_t MinSpins = 4, std::size_t MaxSpins = 1024>
+class exponential_backoff {
+    static_assert(MinSpins > 0 && MinSpins <= MaxSpins);
+
+public:
+    void operator()() noexcept {
+        if (limit_ > MaxSpins) [[unlikely]] {
+            std::this_thread::yield();
+            return;
+        }
+        auto half = limit_ / 2;
+        auto spins = limit_ - half + detail::get_backoff_random() % (half + 1);
+        for (std::size_t i = 0; i < spins; ++i) {
+            detail::cpu_relax();
+        }
+        limit_ *= 2;
+    }
+
+private:
+    std::size_t limit_{MinSpins};
+};
+
 template<class Backoff>
 struct backoff {
     template<class Base>
@@ -26,4 +78,4 @@ struct backoff {
 
 }// namespace lu
 
-#endif
\ No newline at end of file
+#endif
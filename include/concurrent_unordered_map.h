@@ -0,0 +1,524 @@
+#ifndef __CONCURRENT_UNORDERED_MAP_H__
+#define __CONCURRENT_UNORDERED_MAP_H__
+
+#include "back_off.h"
+#include "hazard_pointer.h"
+#include "ordered_list.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+inline std::size_t reverse_bits(std::size_t value) noexcept {
+    static_assert(sizeof(std::size_t) == sizeof(std::uint64_t), "Split order keys need 64-bit size_t");
+    value = ((value >> 1) & 0x5555555555555555) | ((value & 0x5555555555555555) << 1);
+    value = ((value >> 2) & 0x3333333333333333) | ((value & 0x3333333333333333) << 2);
+    value = ((value >> 4) & 0x0f0f0f0f0f0f0f0f) | ((value & 0x0f0f0f0f0f0f0f0f) << 4);
+    value = ((value >> 8) & 0x00ff00ff00ff00ff) | ((value & 0x00ff00ff00ff00ff) << 8);
+    value = ((value >> 16) & 0x0000ffff0000ffff) | ((value & 0x0000ffff0000ffff) << 16);
+    return std::rotl(value, 32);
+}
+
+/*
+  Split order: the list is sorted by the bit-reversed hash, so the nodes of a bucket stay together and
+  the nodes of its two halves after a split follow each other. Bucket heads have even orders, values
+  odd ones; the highest bit of a hash never selects a bucket and is given up for that.
+*/
+inline std::size_t get_dummy_order(std::size_t bucket) noexcept {
+    return reverse_bits(bucket);
+}
+
+inline std::size_t get_regular_order(std::size_t hash) noexcept {
+    return reverse_bits(hash) | 1;
+}
+
+/*
+  A value or, without one, the head of a bucket.
+*/
+template<class ValueType>
+class SplitOrderedValue {
+public:
+    explicit SplitOrderedValue(std::size_t order) noexcept
+        : order_(order) {}
+
+    template<class... Args>
+    explicit SplitOrderedValue(std::in_place_t, Args &&...args)
+        : order_(1)
+        , storage_(std::forward<Args>(args)...) {}
+
+    SplitOrderedValue(const SplitOrderedValue &) = delete;
+
+    SplitOrderedValue(SplitOrderedValue &&) = delete;
+
+    ~SplitOrderedValue() {
+        if (!is_dummy()) {
+            storage_.destroy();
+        }
+    }
+
+    bool is_dummy() const noexcept {
+        return !(order_ & 1);
+    }
+
+    std::size_t get_order() const noexcept {
+        return order_;
+    }
+
+    void set_order(std::size_t order) noexcept {
+        order_ = order;
+    }
+
+    ValueType &get() noexcept {
+        return *storage_;
+    }
+
+    const ValueType &get() const noexcept {
+        return *storage_.operator->();
+    }
+
+private:
+    std::size_t order_;
+    AlignedStorage<ValueType> storage_;
+};
+
+template<class KeyType>
+struct SplitOrderedKey {
+    std::size_t order;
+    const KeyType *key;
+};
+
+template<class ValueType, class KeySelect>
+struct SplitOrderedKeySelect {
+    using key_type = std::remove_cvref_t<typename KeySelect::type>;
+    using type = SplitOrderedKey<key_type>;
+
+    type operator()(const SplitOrderedValue<ValueType> &value) const {
+        if (value.is_dummy()) {
+            return type{value.get_order(), nullptr};
+        }
+        KeySelect key_select;
+        return type{value.get_order(), &key_select(value.get())};
+    }
+};
+
+/*
+  Values of the same order are ordered by their keys. Orders of a head and of a value never match.
+*/
+template<class SplitKey, class KeyCompare>
+class SplitOrderedKeyCompare : private EmptyBaseHolder<KeyCompare> {
+    using KeyCompareHolder = EmptyBaseHolder<KeyCompare>;
+
+public:
+    explicit SplitOrderedKeyCompare(const KeyCompare &compare = {})
+        : KeyCompareHolder(compare) {}
+
+    bool operator()(const SplitKey &left, const SplitKey &right) const {
+        if (left.order != right.order) {
+            return left.order < right.order;
+        }
+        if (!left.key || !right.key) {
+            return false;
+        }
+        auto comp = KeyCompareHolder::get();
+        return comp(*left.key, *right.key);
+    }
+};
+
+template<class ListIterator, class ValueType, bool IsConst>
+class SplitOrderedIterator {
+    template<class, class, class, class, class>
+    friend class SplitOrderedList;
+
+    template<class, class, bool>
+    friend class SplitOrderedIterator;
+
+public:
+    using value_type = ValueType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const ValueType *, ValueType *>;
+    using reference = std::conditional_t<IsConst, const ValueType &, ValueType &>;
+    using iterator_category = std::forward_iterator_tag;
+
+private:
+    explicit SplitOrderedIterator(ListIterator current) noexcept
+        : current_(std::move(current)) {
+        skip_dummies();
+    }
+
+public:
+    SplitOrderedIterator() = default;
+
+    template<class OtherIterator, bool IsOtherConst,
+             class = std::enable_if_t<!std::is_same_v<ListIterator, OtherIterator> && (IsConst || !IsOtherConst)
+                                      && std::is_constructible_v<ListIterator, const OtherIterator &>>>
+    SplitOrderedIterator(const SplitOrderedIterator<OtherIterator, ValueType, IsOtherConst> &other) noexcept
+        : current_(other.current_) {}
+
+    SplitOrderedIterator &operator++() noexcept {
+        ++current_;
+        skip_dummies();
+        return *this;
+    }
+
+    SplitOrderedIterator operator++(int) noexcept {
+        SplitOrderedIterator copy(*this);
+        ++*this;
+        return copy;
+    }
+
+    reference operator*() const noexcept {
+        return current_->get();
+    }
+
+    pointer operator->() const noexcept {
+        return &current_->get();
+    }
+
+    friend bool operator==(const SplitOrderedIterator &left, const SplitOrderedIterator &right) {
+        return left.current_ == right.current_;
+    }
+
+    friend bool operator!=(const SplitOrderedIterator &left, const SplitOrderedIterator &right) {
+        return !(left == right);
+    }
+
+private:
+    void skip_dummies() noexcept {
+        while (current_ != ListIterator() && current_->is_dummy()) {
+            ++current_;
+        }
+    }
+
+private:
+    ListIterator current_{};
+};
+
+/*
+  Split-ordered list (Shalev, Shavit): one OrderedList holds all values and the buckets point into it
+  at their head nodes. Doubling the number of buckets moves nothing, a new bucket is initialized on first
+  use by linking its head after the head of its parent bucket, the one without the highest bit. Buckets
+  live in segments of growing size that are allocated on demand, so the table grows without locks and
+  without a rehash. Heads are never removed and are walked without protection.
+*/
+template<class ValueType, class KeySelect, class Hash, class KeyCompare, class Backoff>
+class SplitOrderedList : private EmptyBaseHolder<Hash> {
+    using HashHolder = EmptyBaseHolder<Hash>;
+
+    using split_value = SplitOrderedValue<ValueType>;
+    using split_key_select = SplitOrderedKeySelect<ValueType, KeySelect>;
+    using split_key = typename split_key_select::type;
+    using split_compare = SplitOrderedKeyCompare<split_key, KeyCompare>;
+
+    using list_type = OrderedList<split_value, split_compare, split_key_select, Backoff>;
+    using node_type = typename list_type::node_type;
+    using node_ptr = node_type *;
+    using position = typename list_type::position;
+
+    using bucket_type = std::atomic<node_ptr>;
+
+    static constexpr std::size_t MIN_BUCKETS = 64;
+    static constexpr std::size_t NUM_OF_SEGMENTS = std::numeric_limits<std::size_t>::digits - log<MIN_BUCKETS>;
+    static constexpr std::size_t MAX_BUCKETS = MIN_BUCKETS << (NUM_OF_SEGMENTS - 1);
+    static constexpr std::size_t MAX_LOAD_FACTOR = 2;
+
+public:
+    using value_type = ValueType;
+    using key_type = typename split_key_select::key_type;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    using hasher = Hash;
+    using compare = KeyCompare;
+    using key_select = KeySelect;
+
+    static constexpr bool is_key_value = !std::is_same_v<value_type, key_type>;
+
+    using guarded_ptr = std::conditional_t<is_key_value, lu::guarded_ptr<ValueType>, lu::guarded_ptr<const ValueType>>;
+
+    using iterator = SplitOrderedIterator<typename list_type::iterator, ValueType, !is_key_value>;
+    using const_iterator = SplitOrderedIterator<typename list_type::const_iterator, ValueType, true>;
+
+public:
+    explicit SplitOrderedList(size_type bucket_count = MIN_BUCKETS, const hasher &hash = {},
+                              const compare &compare = {})
+        : HashHolder(hash)
+        , list_(split_compare(compare))
+        , bucket_count_(std::bit_ceil(std::clamp(bucket_count, MIN_BUCKETS, MAX_BUCKETS))) {
+        node_ptr head = new node_type(get_dummy_order(0));
+        list_.insert_node(head);
+        get_bucket(0).store(head, std::memory_order_release);
+    }
+
+    SplitOrderedList(const SplitOrderedList &) = delete;
+
+    SplitOrderedList(SplitOrderedList &&) = delete;
+
+    ~SplitOrderedList() {
+        list_.clear();
+        for (auto &segment: segments_) {
+            delete[] segment.load(std::memory_order_relaxed);
+        }
+    }
+
+public:
+    bool insert(const value_type &value) {
+        return emplace(value);
+    }
+
+    bool insert(value_type &&value) {
+        return emplace(std::move(value));
+    }
+
+    template<class... Args>
+    bool emplace(Args &&...args) {
+        node_ptr new_node = new node_type(std::in_place, std::forward<Args>(args)...);
+        auto hash = get_hash(KeySelect()(new_node->value.get()));
+        new_node->value.set_order(get_regular_order(hash));
+
+        position pos;
+        if (!list_.insert_node(get_head(hash), new_node, pos)) {
+            delete new_node;
+            return false;
+        }
+        grow(size_.fetch_add(1, std::memory_order_relaxed) + 1);
+        return true;
+    }
+
+    bool erase(const key_type &key) {
+        auto hash = get_hash(key);
+        if (list_.erase(get_head(hash), split_key{get_regular_order(hash), &key})) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    guarded_ptr extract(const key_type &key) {
+        auto hash = get_hash(key);
+        auto extracted = list_.extract(get_head(hash), split_key{get_regular_order(hash), &key});
+        if (!extracted) {
+            return guarded_ptr();
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        auto [guard, ptr] = std::move(extracted).unpack();
+        return guarded_ptr(std::move(guard), &ptr->get());
+    }
+
+    /*
+      The iterator moves on before its value is erased: stepping off a removed node looks it up
+      again from the front of the list.
+    */
+    void clear() {
+        KeySelect key_select;
+        auto it = begin();
+        while (it != end()) {
+            auto current = it++;
+            erase(key_select(*current));
+        }
+    }
+
+    guarded_ptr find(const key_type &key) const {
+        auto hash = get_hash(key);
+        auto found = list_.find(get_head(hash), split_key{get_regular_order(hash), &key});
+        if (!found) {
+            return guarded_ptr();
+        }
+        auto [guard, ptr] = std::move(found).unpack();
+        return guarded_ptr(std::move(guard), &ptr->get());
+    }
+
+    bool contains(const key_type &key) const {
+        auto hash = get_hash(key);
+        position pos;
+        return list_.find(get_head(hash), split_key{get_regular_order(hash), &key}, pos);
+    }
+
+    /*
+      Like the load factor, the values in flight in other threads may or may not be counted.
+    */
+    size_type size() const noexcept {
+        return static_cast<size_type>(std::max<difference_type>(size_.load(std::memory_order_relaxed), 0));
+    }
+
+    bool empty() const noexcept {
+        return !size();
+    }
+
+    size_type bucket_count() const noexcept {
+        return bucket_count_.load(std::memory_order_relaxed);
+    }
+
+    /*
+      The values come in split order, not in the order of the keys.
+    */
+    iterator begin() {
+        return iterator(list_.begin());
+    }
+
+    iterator end() {
+        return iterator();
+    }
+
+    const_iterator cbegin() const {
+        return const_iterator(list_.cbegin());
+    }
+
+    const_iterator cend() const {
+        return const_iterator();
+    }
+
+    const_iterator begin() const {
+        return cbegin();
+    }
+
+    const_iterator end() const {
+        return cend();
+    }
+
+private:
+    std::size_t get_hash(const key_type &key) const {
+        return HashHolder::get()(key);
+    }
+
+    static std::size_t get_segment_index(std::size_t bucket) noexcept {
+        return bucket < MIN_BUCKETS ? 0 : std::bit_width(bucket) - log<MIN_BUCKETS>;
+    }
+
+    static std::size_t get_segment_begin(std::size_t index) noexcept {
+        return index ? MIN_BUCKETS << (index - 1) : 0;
+    }
+
+    static std::size_t get_segment_size(std::size_t index) noexcept {
+        return index ? MIN_BUCKETS << (index - 1) : MIN_BUCKETS;
+    }
+
+    bucket_type &get_bucket(std::size_t bucket) const {
+        auto index = get_segment_index(bucket);
+        auto segment = segments_[index].load(std::memory_order_acquire);
+        if (!segment) [[unlikely]] {
+            auto new_segment = new bucket_type[get_segment_size(index)]{};
+            if (segments_[index].compare_exchange_strong(segment, new_segment, std::memory_order_acq_rel,
+                                                         std::memory_order_acquire)) {
+                segment = new_segment;
+            } else {
+                delete[] new_segment;
+            }
+        }
+        return segment[bucket - get_segment_begin(index)];
+    }
+
+    node_ptr get_dummy(std::size_t bucket) const {
+        auto &slot = get_bucket(bucket);
+        auto dummy = slot.load(std::memory_order_acquire);
+        if (!dummy) [[unlikely]] {
+            dummy = initialize_bucket(bucket, slot);
+        }
+        return dummy;
+    }
+
+    /*
+      Racing threads agree on the head that made it into the list.
+    */
+    node_ptr initialize_bucket(std::size_t bucket, bucket_type &slot) const {
+        auto parent = get_dummy(bucket & ~std::bit_floor(bucket));
+        node_ptr new_dummy = new node_type(get_dummy_order(bucket));
+        position pos;
+        if (!list_.insert_node(&parent->next, new_dummy, pos)) {
+            delete new_dummy;
+            new_dummy = pos.cur;
+        }
+        slot.store(new_dummy, std::memory_order_release);
+        return new_dummy;
+    }
+
+    auto get_head(std::size_t hash) const {
+        auto bucket = hash & (bucket_count_.load(std::memory_order_relaxed) - 1);
+        return &get_dummy(bucket)->next;
+    }
+
+    void grow(difference_type size) noexcept {
+        auto bucket_count = bucket_count_.load(std::memory_order_relaxed);
+        auto is_overloaded = static_cast<size_type>(size) > bucket_count * MAX_LOAD_FACTOR;
+        if (is_overloaded && bucket_count < MAX_BUCKETS) [[unlikely]] {
+            bucket_count_.compare_exchange_strong(bucket_count, bucket_count * 2, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    /*
+      Initializing a bucket from a const lookup doesn't change the contents.
+    */
+    mutable list_type list_;
+    mutable std::atomic<bucket_type *> segments_[NUM_OF_SEGMENTS]{};
+    std::atomic<size_type> bucket_count_;
+    alignas(CACHE_LINE_SIZE) std::atomic<difference_type> size_{};
+};
+
+struct SplitOrderedListDefaults {
+    using hash = void;
+    using compare = void;
+    using backoff = void;
+};
+
+}// namespace detail
+}// namespace lu
+
+namespace lu {
+namespace detail {
+
+template<class ValueType, class... Options>
+struct make_concurrent_unordered_set {
+    using pack_options = typename GetPackOptions<SplitOrderedListDefaults, Options...>::type;
+
+    using hash = typename GetOptionOrDefault<typename pack_options::hash, std::hash<ValueType>>::type;
+    using compare = typename GetOptionOrDefault<typename pack_options::compare, std::less<const ValueType>>::type;
+    using backoff = typename GetOptionOrDefault<typename pack_options::backoff, lu::none_backoff>::type;
+    using key_select = SetKeySelect<ValueType>;
+
+    using type = SplitOrderedList<ValueType, key_select, hash, compare, backoff>;
+};
+
+template<class KeyType, class ValueType, class... Options>
+struct make_concurrent_unordered_map {
+    using pack_options = typename GetPackOptions<SplitOrderedListDefaults, Options...>::type;
+
+    using hash = typename GetOptionOrDefault<typename pack_options::hash, std::hash<KeyType>>::type;
+    using compare = typename GetOptionOrDefault<typename pack_options::compare, std::less<const KeyType>>::type;
+    using backoff = typename GetOptionOrDefault<typename pack_options::backoff, lu::none_backoff>::type;
+    using key_select = MapKeySelect<const KeyType, ValueType>;
+
+    using type = SplitOrderedList<std::pair<const KeyType, ValueType>, key_select, hash, compare, backoff>;
+};
+
+}// namespace detail
+
+/*
+  Keys are hashed into buckets, equal hashes are told apart by the compare option, std::less by default.
+*/
+template<class ValueType, class... Options>
+using concurrent_unordered_set = typename detail::make_concurrent_unordered_set<ValueType, Options...>::type;
+
+template<class KeyType, class ValueType, class... Options>
+using concurrent_unordered_map =
+        typename detail::make_concurrent_unordered_map<KeyType, ValueType, Options...>::type;
+
+}// namespace lu
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __ELIMINATION_ARRAY_H__
+#define __ELIMINATION_ARRAY_H__
+
+#include "back_off.h"
+#include "utils.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t DEFAULT_ELIMINATION_SIZE = 8;
+static constexpr std::size_t DEFAULT_ELIMINATION_SPINS = 128;
+
+struct alignas(CACHE_LINE_SIZE) EliminationSlot {
+    std::atomic<std::uintptr_t> offer{};
+};
+
+}// namespace detail
+
+/*
+  Exchanger for the failed CAS of a stack (Hendler, Shavit, Yerushalmi): a push offers its node in a random
+  slot and spins for a while, a pop that finds an offer claims it by setting the low bit, and the pair is done
+  without touching the top of the stack. Only the one who made an offer clears its slot, so a claimed node
+  can't be taken for a new offer that happens to get the same address. The node must not be published yet,
+  the one who takes it owns it.
+*/
+template<class NodeType, std::size_t Size = detail::DEFAULT_ELIMINATION_SIZE,
+         std::size_t Spins = detail::DEFAULT_ELIMINATION_SPINS>
+class elimination_array {
+    static_assert(Size > 0);
+    static_assert(alignof(NodeType) > 1);
+
+    static constexpr std::uintptr_t CLAIMED = 1;
+
+public:
+    /*
+      Returns true if a concurrent take() got the node.
+    */
+    bool offer(NodeType *node) noexcept {
+        auto &slot = get_slot();
+        auto value = reinterpret_cast<std::uintptr_t>(node);
+        std::uintptr_t empty{};
+        if (!slot.offer.compare_exchange_strong(empty, value, std::memory_order_release, std::memory_order_relaxed)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < Spins; ++i) {
+            if (slot.offer.load(std::memory_order_relaxed) != value) {
+                break;
+            }
+            detail::cpu_relax();
+        }
+        return slot.offer.exchange(0, std::memory_order_acquire) != value;
+    }
+
+    NodeType *take() noexcept {
+        auto &slot = get_slot();
+        auto value = slot.offer.load(std::memory_order_acquire);
+        if (!value || (value & CLAIMED)) {
+            return nullptr;
+        }
+        if (!slot.offer.compare_exchange_strong(value, value | CLAIMED, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return reinterpret_cast<NodeType *>(value);
+    }
+
+private:
+    detail::EliminationSlot &get_slot() noexcept {
+        return slots_[detail::get_backoff_random() % Size];
+    }
+
+private:
+    std::array<detail::EliminationSlot, Size> slots_{};
+};
+
+}// namespace lu
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef __EPOCH_DOMAIN_H__
+#define __EPOCH_DOMAIN_H__
+
+#include "asymmetric_fence.h"
+#include "hazard_pointer.h"
+#include "thread_local_list.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t NUM_OF_EPOCH_LIMBOS = 3;
+static constexpr std::size_t NUM_OF_EPOCH_LIMBO_BUCKETS = 32;
+static constexpr std::size_t NUM_OF_EPOCH_DEFERRED_BUCKETS = 8;
+
+/*
+  One more set of limbo buckets for the limbo being reclaimed, it is swapped out of its slot first.
+*/
+struct EpochThreadStorage {
+    using bucket_type = typename HazardRetires::bucket_type;
+
+    std::array<std::array<bucket_type, NUM_OF_EPOCH_LIMBO_BUCKETS>, NUM_OF_EPOCH_LIMBOS + 1> buckets{};
+    std::array<bucket_type, NUM_OF_EPOCH_DEFERRED_BUCKETS> deferred_buckets{};
+};
+
+/*
+  Per-thread state of epoch_domain. The local epoch holds the epoch observed on entering
+  the outermost critical section shifted by one, the lowest bit is set while the thread is inside.
+  Objects retired in epoch e go to limbo e % 3 and can be reclaimed once the global epoch reaches e + 2.
+*/
+class EpochThreadData : private EpochThreadStorage, public lu::thread_local_list_base_hook {
+    friend class lu::epoch_domain;
+
+    using retires_resource = typename HazardRetires::resource;
+
+public:
+    /*
+      Deleters may retire objects of their own (a destroyed node releasing its child). While a limbo
+      is reclaimed such objects are put aside with the newest epoch they were retired in, and moved to
+      their limbo once the walk is done. The domain of the walk routes them here even if the thread
+      has no thread data of it any more, as when the destructor of the domain clears the limbos.
+    */
+    class ReclaimScope {
+    public:
+        ReclaimScope(const void *domain, EpochThreadData &thread_data) noexcept
+            : domain_(domain)
+            , thread_data_(&thread_data)
+            , prev_(get_current()) {
+            thread_data_->is_reclaiming_ = true;
+            get_current() = this;
+        }
+
+        ReclaimScope(const ReclaimScope &) = delete;
+
+        ReclaimScope &operator=(const ReclaimScope &) = delete;
+
+        ~ReclaimScope() {
+            get_current() = prev_;
+            thread_data_->is_reclaiming_ = false;
+        }
+
+    private:
+        friend class EpochThreadData;
+
+        static ReclaimScope *&get_current() noexcept {
+            static thread_local ReclaimScope *current{};
+            return current;
+        }
+
+    private:
+        const void *domain_;
+        EpochThreadData *thread_data_;
+        ReclaimScope *prev_;
+    };
+
+public:
+    EpochThreadData()
+        : limbos_{HazardRetires(retires_resource(buckets[0])), HazardRetires(retires_resource(buckets[1])),
+                  HazardRetires(retires_resource(buckets[2]))}
+        , detached_(retires_resource(buckets[NUM_OF_EPOCH_LIMBOS]))
+        , deferred_(retires_resource(deferred_buckets)) {}
+
+    EpochThreadData(const EpochThreadData &) = delete;
+
+    EpochThreadData(EpochThreadData &&) = delete;
+
+    ~EpochThreadData() {
+        clear();
+    }
+
+    /*
+      The thread data the calling thread is reclaiming on behalf of the domain, if any.
+    */
+    static EpochThreadData *get_reclaiming(const void *domain) noexcept {
+        auto current = ReclaimScope::get_current();
+        if (current && current->domain_ == domain) [[unlikely]] {
+            return current->thread_data_;
+        }
+        return nullptr;
+    }
+
+    /*
+      Reclaims every limbo regardless of the epoch, what the deleters retire on the way included.
+    */
+    void clear(const void *domain = nullptr) {
+        bool has_retires = true;
+        while (has_retires) {
+            has_retires = false;
+            for (std::size_t i = 0; i < NUM_OF_EPOCH_LIMBOS; ++i) {
+                if (!limbos_[i].empty()) {
+                    reclaim_limbo(domain, i);
+                    has_retires = true;
+                }
+            }
+        }
+    }
+
+    bool is_active() const noexcept {
+        return local_epoch_.load(std::memory_order_acquire) & 1;
+    }
+
+    std::uint64_t get_local_epoch() const noexcept {
+        return local_epoch_.load(std::memory_order_acquire) >> 1;
+    }
+
+    void retire(const void *domain, HazardObject &retired, std::uint64_t epoch) {
+        if (is_reclaiming_) [[unlikely]] {
+            deferred_.insert(retired);
+            deferred_epoch_ = std::max(deferred_epoch_, epoch);
+        } else {
+            get_limbo(domain, epoch).insert(retired);
+        }
+        num_of_retires_ += 1;
+        num_of_retired.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*
+      A deleter flushing the domain doesn't start a walk inside the one that called it.
+    */
+    void reclaim(const void *domain, std::uint64_t global_epoch) {
+        if (is_reclaiming_) [[unlikely]] {
+            return;
+        }
+        for (std::size_t i = 0; i < NUM_OF_EPOCH_LIMBOS; ++i) {
+            if (!limbos_[i].empty() && limbo_epochs_[i] + 2 <= global_epoch) {
+                reclaim_limbo(domain, i);
+            }
+        }
+    }
+
+    /*
+      Limbos with the same index hold epochs that are equal modulo 3, an older one is already safe
+      to reclaim at the newer epoch, so keeping the newer epoch for the merged limbo is conservative.
+    */
+    void merge(EpochThreadData &other) {
+        for (std::size_t i = 0; i < NUM_OF_EPOCH_LIMBOS; ++i) {
+            if (other.limbos_[i].empty()) {
+                continue;
+            }
+            limbo_epochs_[i] = std::max(limbo_epochs_[i], other.limbo_epochs_[i]);
+            num_of_retires_ += other.limbos_[i].size();
+            other.num_of_retires_ -= other.limbos_[i].size();
+            limbos_[i].merge(other.limbos_[i]);
+        }
+    }
+
+    std::size_t num_of_retires() const noexcept {
+        return num_of_retires_;
+    }
+
+private:
+    HazardRetires &get_limbo(const void *domain, std::uint64_t epoch) {
+        std::size_t index = epoch % NUM_OF_EPOCH_LIMBOS;
+        if (limbo_epochs_[index] != epoch) {
+            reclaim_limbo(domain, index);
+            limbo_epochs_[index] = epoch;
+        }
+        return limbos_[index];
+    }
+
+    /*
+      The objects retired by the deleters of a walk land in a limbo that may itself be due, so moving
+      them can start another walk. That is how a chain of objects owning each other gets unrolled.
+    */
+    void reclaim_limbo(const void *domain, std::size_t index) {
+        reclaim_detached(domain, index);
+        while (!deferred_.empty()) [[unlikely]] {
+            auto epoch = deferred_epoch_;
+            std::size_t target = epoch % NUM_OF_EPOCH_LIMBOS;
+            if (limbo_epochs_[target] < epoch && !limbos_[target].empty()) {
+                reclaim_detached(domain, target);
+                continue;
+            }
+            limbo_epochs_[target] = std::max(limbo_epochs_[target], epoch);
+            limbos_[target].merge(deferred_);
+            deferred_epoch_ = 0;
+        }
+    }
+
+    /*
+      The limbo is swapped out of its slot before the walk, so nothing a deleter does can reach the set
+      being walked.
+    */
+    void reclaim_detached(const void *domain, std::size_t index) {
+        detached_.swap(limbos_[index]);
+        std::size_t count{};
+        {
+            ReclaimScope scope(domain, *this);
+            count = detached_.reclaim();
+        }
+        detached_.shrink_to_fit();
+        num_of_retires_ -= count;
+        num_of_reclaimed.fetch_add(count, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> local_epoch_{};
+    std::size_t nesting_{};
+
+    std::array<HazardRetires, NUM_OF_EPOCH_LIMBOS> limbos_;
+    std::array<std::uint64_t, NUM_OF_EPOCH_LIMBOS> limbo_epochs_{};
+    std::size_t num_of_retires_{};
+
+    HazardRetires detached_;
+    HazardRetires deferred_;
+    std::uint64_t deferred_epoch_{};
+    bool is_reclaiming_{};
+
+    std::atomic<std::size_t> num_of_retired{};
+    std::atomic<std::size_t> num_of_reclaimed{};
+};
+
+}// namespace detail
+
+/*
+  Epoch based reclamation: readers announce the epoch they entered in and a retired object is reclaimed
+  once every thread inside a critical section has moved two epochs past it. Entering costs a store and
+  a fence per critical section instead of per protected node, but a stalled reader blocks reclamation.
+*/
+class epoch_domain {
+    template<class, class, class>
+    friend class detail::HazardObjectBase;
+
+    friend class epoch_guard;
+
+    using EpochThreadData = detail::EpochThreadData;
+    using HazardObject = detail::HazardObject;
+
+    struct Detacher {
+        explicit Detacher(epoch_domain *domain)
+            : domain_(domain) {}
+
+        void operator()(EpochThreadData *thread_data) const {
+            assert(!thread_data->is_active() && "Can't detach thread inside a critical section");
+            domain_->help_reclaim(*thread_data);
+        }
+
+    private:
+        epoch_domain *domain_;
+    };
+
+public:
+    explicit epoch_domain(std::size_t scan_threshold = DEFAULT_SCAN_THRESHOLD,
+                          fence_policy fence = fence_policy::symmetric)
+        : scan_threshold_(scan_threshold)
+        , is_asymmetric_(fence == fence_policy::asymmetric && detail::AsymmetricFence::is_supported())
+        , list_(Detacher(this)) {}
+
+    epoch_domain(const epoch_domain &) = delete;
+
+    epoch_domain(epoch_domain &&) = delete;
+
+    ~epoch_domain() {
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            it->clear(this);
+        }
+    }
+
+    void attach_thread() {
+        list_.attach_thread();
+    }
+
+    void detach_thread() {
+        list_.detach_thread();
+    }
+
+    template<class Iterator>
+    void retire_batch(Iterator first, Iterator last) {
+        retire_batch(first, last, [](auto retired) { retired->prepare_retire(); });
+    }
+
+    fence_policy get_fence_policy() const noexcept {
+        return is_asymmetric_ ? fence_policy::asymmetric : fence_policy::symmetric;
+    }
+
+    std::uint64_t get_epoch() const noexcept {
+        return global_epoch_.load(std::memory_order_acquire);
+    }
+
+    /*
+      Advances the epoch as far as the threads inside critical sections allow and reclaims
+      what became safe among the objects retired by the calling thread.
+    */
+    void flush() {
+        auto &thread_data = list_.get_thread_local();
+        for (std::size_t i = 0; i < detail::NUM_OF_EPOCH_LIMBOS; ++i) {
+            if (!try_advance()) {
+                break;
+            }
+        }
+        thread_data.reclaim(this, get_epoch());
+    }
+
+    std::size_t num_of_retired() {
+        std::size_t result{};
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            result += it->num_of_retired.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    std::size_t num_of_reclaimed() {
+        std::size_t result{};
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            result += it->num_of_reclaimed.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+private:
+    void retire(HazardObject *retired) {
+        auto epoch = global_epoch_.load(std::memory_order_seq_cst);
+        if (auto reclaiming = EpochThreadData::get_reclaiming(this)) [[unlikely]] {
+            reclaiming->retire(this, *retired, epoch);
+            return;
+        }
+        auto &thread_data = list_.get_thread_local();
+        thread_data.retire(this, *retired, epoch);
+        if (thread_data.num_of_retires() >= scan_threshold_) [[unlikely]] {
+            try_reclaim(thread_data);
+        }
+    }
+
+    template<class Iterator, class Prepare>
+    void retire_batch(Iterator first, Iterator last, Prepare &&prepare) {
+        if (first == last) {
+            return;
+        }
+        auto epoch = global_epoch_.load(std::memory_order_seq_cst);
+        auto reclaiming = EpochThreadData::get_reclaiming(this);
+        auto &thread_data = reclaiming ? *reclaiming : list_.get_thread_local();
+        for (; first != last; ++first) {
+            auto retired = lu::to_raw_pointer(*first);
+            prepare(retired);
+            thread_data.retire(this, *retired, epoch);
+        }
+        if (reclaiming) [[unlikely]] {
+            return;
+        }
+        if (thread_data.num_of_retires() >= scan_threshold_) [[unlikely]] {
+            try_reclaim(thread_data);
+        }
+    }
+
+    EpochThreadData &enter() {
+        auto &thread_data = list_.get_thread_local();
+        if (!thread_data.nesting_++) {
+            auto epoch = global_epoch_.load(std::memory_order_relaxed);
+            thread_data.local_epoch_.store((epoch << 1) | 1, std::memory_order_relaxed);
+            protection_fence();
+        }
+        return thread_data;
+    }
+
+    void leave(EpochThreadData &thread_data) noexcept {
+        assert(thread_data.nesting_ && "Unbalanced critical section");
+        if (!--thread_data.nesting_) {
+            thread_data.local_epoch_.store(0, std::memory_order_release);
+        }
+    }
+
+    inline void protection_fence() const noexcept {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::light();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void advance_fence() const {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::heavy();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    bool try_advance() {
+        auto epoch = global_epoch_.load(std::memory_order_seq_cst);
+        advance_fence();
+        for (auto current = list_.begin(); current != list_.end(); ++current) {
+            if (current->is_active() && current->get_local_epoch() != epoch) {
+                return false;
+            }
+        }
+        global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void try_reclaim(EpochThreadData &thread_data) {
+        try_advance();
+        thread_data.reclaim(this, get_epoch());
+    }
+
+    void help_reclaim(EpochThreadData &thread_data) {
+        for (auto current = list_.begin(); current != list_.end(); ++current) {
+            if (current->try_acquire()) {
+                thread_data.merge(*current);
+                current->release();
+            }
+        }
+        for (std::size_t i = 0; i < detail::NUM_OF_EPOCH_LIMBOS; ++i) {
+            if (!try_advance()) {
+                break;
+            }
+        }
+        thread_data.reclaim(this, get_epoch());
+    }
+
+private:
+    const std::size_t scan_threshold_;
+    const bool is_asymmetric_;
+    std::atomic<std::uint64_t> global_epoch_{};
+    lu::thread_local_list<EpochThreadData> list_;
+};
+
+inline epoch_domain &get_default_epoch_domain() {
+    static epoch_domain domain(DEFAULT_SCAN_THRESHOLD);
+    return domain;
+}
+
+/*
+  Scoped critical section: objects reachable when the guard was made can't be reclaimed
+  while it's alive. Guards of the same thread nest.
+*/
+class epoch_guard {
+public:
+    epoch_guard() noexcept = default;
+
+    explicit epoch_guard(epoch_domain &domain)
+        : domain_(&domain)
+        , thread_data_(&domain.enter()) {}
+
+    epoch_guard(const epoch_guard &) = delete;
+
+    epoch_guard(epoch_guard &&other) noexcept
+        : domain_(std::exchange(other.domain_, nullptr))
+        , thread_data_(std::exchange(other.thread_data_, nullptr)) {}
+
+    epoch_guard &operator=(const epoch_guard &) = delete;
+
+    epoch_guard &operator=(epoch_guard &&other) noexcept {
+        epoch_guard temp(std::move(other));
+        swap(temp);
+        return *this;
+    }
+
+    ~epoch_guard() {
+        reset();
+    }
+
+    bool empty() const noexcept {
+        return !domain_;
+    }
+
+    explicit operator bool() const noexcept {
+        return !empty();
+    }
+
+    void reset() noexcept {
+        if (domain_) {
+            domain_->leave(*thread_data_);
+            domain_ = nullptr;
+            thread_data_ = nullptr;
+        }
+    }
+
+    void swap(epoch_guard &other) noexcept {
+        std::swap(domain_, other.domain_);
+        std::swap(thread_data_, other.thread_data_);
+    }
+
+    friend void swap(epoch_guard &left, epoch_guard &right) noexcept {
+        left.swap(right);
+    }
+
+private:
+    epoch_domain *domain_{};
+    detail::EpochThreadData *thread_data_{};
+};
+
+inline epoch_guard make_epoch_guard(epoch_domain &domain = get_default_epoch_domain()) {
+    return epoch_guard(domain);
+}
+
+}// namespace lu
+
+#endif
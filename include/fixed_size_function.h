@@ -137,14 +137,14 @@ private:
 
     void Copy(const fixed_size_function &other) {
         if (other.table_.copy) {
-            other.table_.copy(&data_, &other);
+            other.table_.copy(&data_, &other.data_);
             table_ = other.table_;
         }
     }
 
     void Move(fixed_size_function &&other) {
         if (other.table_.move) {
-            other.table_.move(&data_, &other);
+            other.table_.move(&data_, &other.data_);
             table_ = other.table_;
             other.Destruct();
         } else if (other.table_.copy) {
@@ -181,7 +181,7 @@ private:
 
 private:
     vtable table_;
-    storage data_;
+    alignas(std::max_align_t) storage data_;
 };
 
 }// namespace lu
@@ -0,0 +1,354 @@
+#ifndef __HAZARD_ERA_DOMAIN_H__
+#define __HAZARD_ERA_DOMAIN_H__
+
+#include "asymmetric_fence.h"
+#include "hazard_pointer.h"
+#include "thread_local_list.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace lu {
+
+/*
+  Hazard eras: the records publish the era a reader is running in instead of a pointer and every object
+  carries the eras of its birth and of its retirement. An object is reclaimed once no published era
+  falls into its lifetime. A reader republishes only when the era clock has moved, and a stalled reader
+  only holds back the objects that were alive in its era, so memory stays bounded.
+*/
+class hazard_era_domain {
+    template<class, class, class>
+    friend class detail::HazardObjectBase;
+
+    friend class hazard_era;
+
+    using HazardThreadData = detail::HazardThreadData;
+    using HazardEraObject = detail::HazardEraObject;
+    using HazardRecord = detail::HazardRecord;
+    using EraClock = detail::EraClock;
+
+    using Creator = detail::HazardThreadDataCreator;
+    using Deleter = detail::HazardThreadDataDeleter;
+
+    struct Detacher {
+        explicit Detacher(hazard_era_domain *domain)
+            : domain_(domain) {}
+
+        void operator()(HazardThreadData *) const {
+            domain_->help_scan();
+        }
+
+    private:
+        hazard_era_domain *domain_;
+    };
+
+public:
+    hazard_era_domain(std::size_t num_of_records, std::size_t num_of_retires, std::size_t scan_threshold,
+                      fence_policy fence = fence_policy::symmetric, layout_policy layout = layout_policy::compact)
+        : scan_threshold_(scan_threshold)
+        , is_asymmetric_(fence == fence_policy::asymmetric && detail::AsymmetricFence::is_supported())
+        , list_(Detacher(this), Creator(num_of_records, num_of_retires, layout), Deleter()) {}
+
+    hazard_era_domain(const hazard_era_domain &) = delete;
+
+    hazard_era_domain(hazard_era_domain &&) = delete;
+
+    ~hazard_era_domain() {
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            it->clear(this);
+        }
+    }
+
+    void attach_thread() {
+        list_.attach_thread();
+    }
+
+    void detach_thread() {
+        list_.detach_thread();
+    }
+
+    template<class Iterator>
+    void retire_batch(Iterator first, Iterator last) {
+        retire_batch(first, last, [](auto retired) { retired->prepare_retire(); });
+    }
+
+    fence_policy get_fence_policy() const noexcept {
+        return is_asymmetric_ ? fence_policy::asymmetric : fence_policy::symmetric;
+    }
+
+    std::size_t get_scan_threshold() const noexcept {
+        return scan_threshold_;
+    }
+
+    void flush() {
+        scan();
+    }
+
+    std::size_t num_of_retired() {
+        std::size_t result{};
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            result += it->num_of_retired.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    std::size_t num_of_reclaimed() {
+        std::size_t result{};
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            result += it->num_of_reclaimed.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    reclamation_stats get_stats() {
+        reclamation_stats result{};
+        for (auto it = list_.begin(); it != list_.end(); ++it) {
+            it->counters_.collect(result);
+        }
+        return result;
+    }
+
+    /*
+      Same as hazard_pointer_domain::set_stats_hook(), inspected records are the published eras.
+    */
+    void set_stats_hook(stats_hook hook) {
+        stats_hook_ = std::move(hook);
+    }
+
+private:
+    /*
+      The retire era is read after the object was unlinked, so a reader that publishes a later era
+      can't reach it any more.
+    */
+    void retire(HazardEraObject *retired) {
+        retired->retire_era_ = EraClock::now(std::memory_order_seq_cst);
+        if (auto reclaiming = HazardThreadData::get_reclaiming(this)) [[unlikely]] {
+            reclaiming->retire(*retired);
+            return;
+        }
+        auto &thread_data = list_.get_thread_local();
+        thread_data.retire(*retired);
+        if (thread_data.num_of_retires() >= scan_threshold_) [[unlikely]] {
+            scan();
+        }
+    }
+
+    template<class Iterator, class Prepare>
+    void retire_batch(Iterator first, Iterator last, Prepare &&prepare) {
+        if (first == last) {
+            return;
+        }
+        auto era = EraClock::now(std::memory_order_seq_cst);
+        auto stamp = [&prepare, era](auto retired) {
+            prepare(retired);
+            retired->retire_era_ = era;
+        };
+        if (auto reclaiming = HazardThreadData::get_reclaiming(this)) [[unlikely]] {
+            reclaiming->retire(first, last, stamp);
+            return;
+        }
+        auto &thread_data = list_.get_thread_local();
+        thread_data.retire(first, last, stamp);
+        if (thread_data.num_of_retires() >= scan_threshold_) [[unlikely]] {
+            scan();
+        }
+    }
+
+    HazardRecord *acquire_record() noexcept {
+        auto &thread_data = list_.get_thread_local();
+        return thread_data.acquire_record();
+    }
+
+    void release_record(HazardRecord *record) noexcept {
+        auto &thread_data = list_.get_thread_local();
+        thread_data.release_record(record);
+    }
+
+    inline void protection_fence() const noexcept {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::light();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void scan_fence() const {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::heavy();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    /*
+      Advancing the clock first lets readers that republish after this scan stop covering
+      the objects retired so far. Objects retired by the deleters get another pass, as in
+      hazard_pointer_domain::scan_impl().
+    */
+    void scan() {
+        auto &thread_data = list_.get_thread_local();
+        auto &retires = thread_data.retires_;
+        auto &snapshot = thread_data.snapshot_;
+        bool has_deferred = true;
+        while (has_deferred) {
+            auto num_of_scanned = retires.size();
+            auto start = thread_data.counters_.start_scan(num_of_scanned);
+            EraClock::try_advance(EraClock::now(std::memory_order_seq_cst));
+            scan_fence();
+
+            std::size_t num_of_inspected{};
+            snapshot.clear();
+            for (auto current = list_.begin(); current != list_.end(); ++current) {
+                if (!current->is_acquired()) {
+                    continue;
+                }
+                current->records_.visit([&snapshot, &num_of_inspected](const HazardRecord &record) {
+                    ++num_of_inspected;
+                    auto era = record.get_era();
+                    if (era) {
+                        snapshot.push(era);
+                    }
+                });
+            }
+            snapshot.prepare();
+
+            HazardThreadData::ReclaimScope scope(this, thread_data);
+            auto current = retires.begin();
+            while (current != retires.end()) {
+                auto prev = current++;
+                auto &era_object = static_cast<HazardEraObject &>(*prev);
+                if (!snapshot.contains_any(era_object.birth_era_, era_object.retire_era_)) {
+                    thread_data.reclaim(*prev);
+                }
+            }
+            auto sample = thread_data.counters_.finish_scan(start, num_of_inspected, num_of_scanned, retires.size());
+            has_deferred = scope.finish();
+            retires.shrink_to_fit();
+            if constexpr (detail::STATS_ENABLED) {
+                if (stats_hook_) {
+                    stats_hook_(sample);
+                }
+            }
+        }
+    }
+
+    void help_scan() {
+        auto &thread_data = list_.get_thread_local();
+        auto num_of_retires = thread_data.num_of_retires();
+        for (auto current = list_.begin(); current != list_.end(); ++current) {
+            if (current->try_acquire()) {
+                thread_data.merge(*current);
+                current->release();
+            }
+        }
+        thread_data.counters_.add_merged_orphans(thread_data.num_of_retires() - num_of_retires);
+        scan();
+    }
+
+private:
+    const std::size_t scan_threshold_;
+    const bool is_asymmetric_;
+    lu::thread_local_list<HazardThreadData> list_;
+    stats_hook stats_hook_{};
+};
+
+inline hazard_era_domain &get_default_era_domain() {
+    static hazard_era_domain domain(DEFAULT_NUM_OF_RECORDS, DEFAULT_NUM_OF_RETIRES, DEFAULT_SCAN_THRESHOLD);
+    return domain;
+}
+
+/*
+  Reserves the current era in a hazard record. Like hazard_pointer it protects the object returned
+  by the last protect(), but the record is only written when the era clock has moved since then.
+*/
+class hazard_era {
+    using HazardObject = detail::HazardObject;
+    using HazardRecord = detail::HazardRecord;
+    using EraClock = detail::EraClock;
+
+public:
+    hazard_era() = default;
+
+    explicit hazard_era(hazard_era_domain *domain) noexcept
+        : domain_(domain)
+        , record_(domain_->acquire_record()) {}
+
+    hazard_era(const hazard_era &) = delete;
+
+    hazard_era(hazard_era &&other) noexcept
+        : domain_(other.domain_)
+        , record_(other.record_) {
+        other.record_ = {};
+    }
+
+    hazard_era &operator=(const hazard_era &) = delete;
+
+    hazard_era &operator=(hazard_era &&other) noexcept {
+        hazard_era temp(std::move(other));
+        swap(temp);
+        return *this;
+    }
+
+    ~hazard_era() {
+        if (record_) [[likely]] {
+            domain_->release_record(record_);
+        }
+    }
+
+public:
+    bool empty() const noexcept {
+        return !record_;
+    }
+
+    explicit operator bool() const noexcept {
+        return !empty();
+    }
+
+    template<class Ptr,
+             class = std::enable_if_t<std::is_base_of_v<HazardObject, typename std::pointer_traits<Ptr>::element_type>>>
+    Ptr protect(const std::atomic<Ptr> &src) noexcept {
+        assert(!empty() && "hazard_era must be initialized");
+        auto prev_era = record_->get_era();
+        while (true) {
+            auto ptr = src.load(std::memory_order_acquire);
+            auto era = EraClock::now();
+            if (era == prev_era) [[likely]] {
+                return ptr;
+            }
+            record_->reset_era(era);
+            domain_->protection_fence();
+            prev_era = era;
+        }
+    }
+
+    void reset_protection(nullptr_t = nullptr) noexcept {
+        assert(!empty() && "hazard_era must be initialized");
+        record_->reset_era();
+    }
+
+    void swap(hazard_era &other) noexcept {
+        std::swap(domain_, other.domain_);
+        std::swap(record_, other.record_);
+    }
+
+    friend void swap(hazard_era &left, hazard_era &right) noexcept {
+        left.swap(right);
+    }
+
+private:
+    hazard_era_domain *domain_{};
+    HazardRecord *record_{};
+};
+
+inline hazard_era make_hazard_era(hazard_era_domain &domain = get_default_era_domain()) {
+    return hazard_era(&domain);
+}
+
+}// namespace lu
+
+#endif
@@ -1,76 +1,193 @@
 #ifndef __HAZARD_POINTERS_H__
 #define __HAZARD_POINTERS_H__
 
+#include "asymmetric_fence.h"
 #include "intrusive/forward_list.h"
 #include "intrusive/options.h"
 #include "intrusive/unordered_set.h"
+#include "intrusive/utils.h"
+#include "linear_search.h"
+#include "marked_ptr.h"
+#include "numa.h"
+#include "reclamation_stats.h"
 #include "thread_local_list.h"
 #include "utils.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <span>
+#include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 
 namespace lu {
 
+enum class fence_policy : std::uint8_t { symmetric, asymmetric };
+
+enum class threshold_policy : std::uint8_t { fixed, adaptive };
+
+enum class layout_policy : std::uint8_t { compact, padded };
+
+enum class numa_policy : std::uint8_t { none, local, hierarchical };
+
+/*
+  The reclaimer thread wakes up once num_of_batches batches were handed over to it (never if it's zero)
+  or after interval, whichever comes first.
+*/
+struct reclaimer_wakeup {
+    std::size_t num_of_batches = 1;
+    std::chrono::milliseconds interval = std::chrono::milliseconds(10);
+};
+
+enum class budget_policy : std::uint8_t { callback, block };
+
+/*
+  Cap on the objects retired to a domain and not reclaimed yet, zero means no cap. A thread whose retire finds
+  the domain over it scans right away, then adopts and scans what detached threads have left. If the domain
+  is still over and the thread couldn't get rid of its own backlog (someone protects it),
+  budget_policy::callback calls the budget hook and returns, budget_policy::block keeps helping until either
+  is gone, so the blocked thread must not protect the objects it waits for itself.
+*/
+struct retire_budget {
+    std::size_t max_pending = 0;
+    budget_policy policy = budget_policy::callback;
+};
+
+using budget_hook = lu::fixed_size_function<void(std::size_t num_of_pending), 64>;
+
 class hazard_pointer_domain;
 
-template<class, class>
-class hazard_pointer_obj_base;
+class epoch_domain;
+
+class hazard_era_domain;
+
+template<std::size_t>
+class hazard_pointer_array;
 
 namespace detail {
 
+template<class, class, class>
+class HazardObjectBase;
+
+static constexpr std::size_t BUDGET_QUANTUM = 32;
+
 class HazardPointerTag {};
 
 using HazardPointerHook
         = lu::unordered_set_base_hook<lu::tag<HazardPointerTag>, lu::store_hash<false>, lu::is_auto_unlink<false>>;
 
+/*
+  Process-wide era clock of the hazard era scheme. Every object records the era it was born in,
+  hazard_era_domain advances the clock on each scan.
+*/
+class EraClock {
+public:
+    using era_type = std::uintptr_t;
+
+    static era_type now(std::memory_order order = std::memory_order_acquire) noexcept {
+        return era_.load(order);
+    }
+
+    static void try_advance(era_type era) noexcept {
+        era_.compare_exchange_strong(era, era + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    static inline std::atomic<era_type> era_{1};
+};
+
+/*
+  Header shared by all reclaimable objects: the hook of the retire set and the reclaimer. The protected
+  mark of a scan lives in the low bit of the reclaimer pointer, which points to a static variable.
+*/
 class HazardObject : public HazardPointerHook {
     friend class HazardThreadData;
 
+    friend class HazardRetires;
+
     friend class lu::hazard_pointer_domain;
 
-    template<class, class>
-    friend class lu::hazard_pointer_obj_base;
+    friend class lu::hazard_era_domain;
+
+    template<class, class, class>
+    friend class HazardObjectBase;
 
     using ReclaimFunc = void(HazardObject *value);
     using ReclaimFuncPtr = void (*)(HazardObject *value);
 
-private:
+protected:
+    HazardObject() noexcept = default;
+
+    HazardObject(const HazardObject &) noexcept
+        : HazardObject() {}
+
     ~HazardObject() {
         assert(!this->is_linked());
     }
 
+private:
     void reclaim() {
-        reclaim_func_(this);
+        (*reclaimer_)(this);
     }
 
-    void set_reclaimer(ReclaimFuncPtr reclaim_func) noexcept {
-        reclaim_func_ = reclaim_func;
+    void set_reclaimer(const ReclaimFuncPtr *reclaimer) noexcept {
+        reclaimer_ = reclaimer;
+    }
+
+    bool is_retired() const noexcept {
+        return reclaimer_.get() != nullptr;
     }
 
     bool is_protected() const noexcept {
-        return protected_;
+        return reclaimer_.get_bit();
     }
 
     void make_protected() noexcept {
-        protected_ = true;
+        reclaimer_.set_bit();
     }
 
     void make_unprotected() noexcept {
-        protected_ = false;
+        reclaimer_.clear_bit();
     }
 
 private:
-    ReclaimFuncPtr reclaim_func_{};
-    bool protected_{false};
+    lu::marked_ptr<const ReclaimFuncPtr> reclaimer_{};
+};
+
+/*
+  Hazard eras need the eras of the birth and of the retirement of every object, the other domains
+  don't look at them.
+*/
+class HazardEraObject : public HazardObject {
+    friend class lu::hazard_era_domain;
+
+    using era_type = typename EraClock::era_type;
+
+protected:
+    /*
+      A reader can only reach an object after its birth, so a relaxed load is enough: the reader's later
+      load of the clock can't observe an older era than this one.
+    */
+    HazardEraObject() noexcept
+        : birth_era_(EraClock::now(std::memory_order_relaxed)) {}
+
+    HazardEraObject(const HazardEraObject &) noexcept
+        : HazardEraObject() {}
+
+private:
+    era_type birth_era_;
+    era_type retire_era_{};
 };
 
 template<class ValueType>
@@ -86,6 +203,11 @@ using HazardRetiresSet
         = lu::unordered_set<HazardObject, lu::base_hook<HazardPointerHook>, lu::is_power_2_buckets<true>,
                             lu::key_of_value<RawPointerKeyOfValue<HazardObject>>, lu::hash<detail::PointerHash>>;
 
+/*
+  Retired set over the buckets of the thread data blob. When the set outgrows them (protected objects
+  piling up across scans or a merged orphaned backlog) it is rehashed into larger heap buckets and moved
+  back once it is small again. If the buckets can't be allocated the set just gets overloaded.
+*/
 class HazardRetires : public HazardRetiresSet {
     using Base = HazardRetiresSet;
 
@@ -97,18 +219,146 @@ public:
 
 public:
     HazardRetires(resource buckets) noexcept
-        : Base(BucketTraits(buckets.data(), buckets.size())) {
+        : Base(BucketTraits(buckets.data(), buckets.size()))
+        , buckets_(buckets) {
         for (std::size_t i = 0; i < buckets.size(); ++i) {
             ::new (buckets.data() + i) BucketType();
         }
     }
+
+    HazardRetires(const HazardRetires &) = delete;
+
+    HazardRetires(HazardRetires &&) = delete;
+
+    ~HazardRetires() {
+        Base::clear();
+        delete[] heap_buckets_;
+    }
+
+public:
+    void insert(HazardObject &retired) {
+        if (size() >= bucket_count()) [[unlikely]] {
+            reserve(size() + 1);
+        }
+        Base::insert(retired);
+    }
+
+    void merge(HazardRetires &other) {
+        reserve(size() + other.size());
+        Base::merge(other);
+        other.shrink_to_fit();
+    }
+
+    bool reserve(std::size_t num_of_retires) noexcept {
+        if (num_of_retires <= bucket_count()) {
+            return true;
+        }
+        std::size_t new_size = suggested_upper_bucket_count(std::max(num_of_retires, bucket_count() * 2));
+        auto new_buckets = new (std::nothrow) BucketType[new_size]();
+        if (!new_buckets) [[unlikely]] {
+            return false;
+        }
+        rehash(BucketTraits(new_buckets, new_size));
+        delete[] heap_buckets_;
+        heap_buckets_ = new_buckets;
+        return true;
+    }
+
+    std::size_t reclaim() {
+        std::size_t count{};
+        auto current = begin();
+        while (current != end()) {
+            auto prev = current++;
+            erase(prev);
+            prev->reclaim();
+            ++count;
+        }
+        return count;
+    }
+
+    /*
+      Swaps the contents together with the buckets, so both sets must outlive each other's storage.
+    */
+    void swap(HazardRetires &other) noexcept {
+        Base::swap(other);
+        std::swap(buckets_, other.buckets_);
+        std::swap(heap_buckets_, other.heap_buckets_);
+    }
+
+    void shrink_to_fit() noexcept {
+        if (heap_buckets_ && size() * 4 <= buckets_.size()) {
+            for (std::size_t i = 0; i < buckets_.size(); ++i) {
+                ::new (buckets_.data() + i) BucketType();
+            }
+            rehash(BucketTraits(buckets_.data(), buckets_.size()));
+            delete[] heap_buckets_;
+            heap_buckets_ = nullptr;
+        }
+    }
+
+private:
+    resource buckets_;
+    BucketType *heap_buckets_{};
+};
+
+/*
+  Retired objects handed over to the reclaimer thread, allocated together with their buckets.
+  Objects still in a batch when it's destroyed are reclaimed.
+*/
+class HazardRetiresBatch {
+    friend class lu::hazard_pointer_domain;
+
+    using BucketType = typename HazardRetires::bucket_type;
+
+    explicit HazardRetiresBatch(HazardRetires::resource buckets) noexcept
+        : retires_(buckets) {}
+
+public:
+    HazardRetiresBatch(const HazardRetiresBatch &) = delete;
+
+    HazardRetiresBatch(HazardRetiresBatch &&) = delete;
+
+    ~HazardRetiresBatch() {
+        retires_.reclaim();
+    }
+
+    static HazardRetiresBatch *create(HazardRetires &retires) noexcept {
+        std::size_t num_of_buckets = HazardRetires::suggested_upper_bucket_count(retires.size());
+        std::size_t header_size = detail::align_up(sizeof(HazardRetiresBatch), alignof(BucketType));
+        std::size_t buckets_size = sizeof(BucketType) * num_of_buckets;
+
+        auto blob = new (std::nothrow) std::uint8_t[header_size + buckets_size];
+        if (!blob) [[unlikely]] {
+            return nullptr;
+        }
+        auto buckets = reinterpret_cast<BucketType *>(blob + header_size);
+
+        auto batch = ::new (blob) HazardRetiresBatch(HazardRetires::resource(buckets, num_of_buckets));
+        batch->retires_.merge(retires);
+        return batch;
+    }
+
+    static void destroy(HazardRetiresBatch *batch) noexcept {
+        batch->~HazardRetiresBatch();
+        delete[] reinterpret_cast<std::uint8_t *>(batch);
+    }
+
+private:
+    HazardRetires retires_;
+    HazardRetiresBatch *next_{};
 };
 
+/*
+  A record publishes either a protected pointer (hazard_pointer_domain) or a reserved era
+  (hazard_era_domain), zero means nothing is published in both cases.
+*/
 class HazardRecord : public lu::forward_list_base_hook<> {
 public:
     using pointer = HazardObject *;
     using const_pointer = const HazardObject *;
 
+    using era_type = typename EraClock::era_type;
+
 public:
     HazardRecord() = default;
 
@@ -117,10 +367,18 @@ public:
     HazardRecord(HazardRecord &&) = delete;
 
     inline void reset(const_pointer new_ptr = {}) {
-        protected_.store(new_ptr, std::memory_order_release);
+        protected_.store(reinterpret_cast<std::uintptr_t>(new_ptr), std::memory_order_release);
     }
 
     inline const_pointer get() const noexcept {
+        return reinterpret_cast<const_pointer>(protected_.load(std::memory_order_acquire));
+    }
+
+    inline void reset_era(era_type era = {}) {
+        protected_.store(era, std::memory_order_release);
+    }
+
+    inline era_type get_era() const noexcept {
         return protected_.load(std::memory_order_acquire);
     }
 
@@ -129,9 +387,111 @@ public:
     }
 
 private:
-    std::atomic<const_pointer> protected_{};
+    std::atomic<std::uintptr_t> protected_{};
+};
+
+/*
+  Overflow storage for threads that need more hazard records than the inline array holds.
+  Blocks are chained onto HazardRecords on demand and stay with their thread data afterwards,
+  a block without acquired records is skipped by scan().
+*/
+class HazardRecordsBlock {
+    friend class HazardRecords;
+
+public:
+    using resource = std::span<HazardRecord>;
+
+    using value_type = HazardRecord;
+
+    using pointer = typename resource::pointer;
+    using const_pointer = typename resource::const_pointer;
+
+private:
+    HazardRecordsBlock(resource data, std::size_t stride) noexcept
+        : data_(data)
+        , stride_(stride) {
+        for (std::size_t i = 0; i < data_.size(); ++i) {
+            ::new (data_.data() + i) value_type();
+        }
+        for (std::size_t i = 0; i < data_.size(); i += stride_) {
+            free_list_.push_front(data_[i]);
+        }
+    }
+
+public:
+    HazardRecordsBlock(const HazardRecordsBlock &) = delete;
+
+    HazardRecordsBlock(HazardRecordsBlock &&) = delete;
+
+    static HazardRecordsBlock *create(std::size_t num_of_records, std::size_t stride) noexcept {
+        std::size_t header_size = detail::align_up(sizeof(HazardRecordsBlock), CACHE_LINE_SIZE);
+        std::size_t records_size = sizeof(value_type) * num_of_records * stride;
+
+        auto blob = new (std::align_val_t(CACHE_LINE_SIZE), std::nothrow) std::uint8_t[header_size + records_size];
+        if (!blob) [[unlikely]] {
+            return nullptr;
+        }
+        auto records = reinterpret_cast<value_type *>(blob + header_size);
+
+        ::new (blob) HazardRecordsBlock(resource(records, num_of_records * stride), stride);
+        return reinterpret_cast<HazardRecordsBlock *>(blob);
+    }
+
+    static void destroy(HazardRecordsBlock *block) noexcept {
+        block->~HazardRecordsBlock();
+        ::operator delete[](reinterpret_cast<std::uint8_t *>(block), std::align_val_t(CACHE_LINE_SIZE));
+    }
+
+public:
+    pointer acquire() noexcept {
+        pointer record{};
+        if (!free_list_.empty()) {
+            record = &free_list_.front();
+            free_list_.pop_front();
+            num_of_acquired_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return record;
+    }
+
+    void release(pointer record) noexcept {
+        record->reset();
+        free_list_.push_front(*record);
+        num_of_acquired_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool contains(const_pointer record) const noexcept {
+        return (data_.data() <= record) && (data_.data() + data_.size() > record);
+    }
+
+    /*
+      The owner bumps the counter before it publishes a record and the publication is followed
+      by the protection fence, so a scanner that reads zero after its own fence can't miss
+      a protection that is still valid.
+    */
+    bool is_idle() const noexcept {
+        return !num_of_acquired_.load(std::memory_order_relaxed);
+    }
+
+    template<class Visitor>
+    void visit(Visitor &&visitor) const {
+        for (std::size_t i = 0; i < data_.size(); i += stride_) {
+            visitor(data_[i]);
+        }
+    }
+
+private:
+    resource data_;
+    std::size_t stride_;
+    lu::forward_list<HazardRecord> free_list_{};
+    std::atomic<std::size_t> num_of_acquired_{};
+    HazardRecordsBlock *next_{};
 };
 
+/*
+  Records of one thread. With a stride above one only every stride-th record of the array is used,
+  which gives every record a cache line of its own. The free list is written by the owner on every
+  guard, so it's kept away from the fields scanners read.
+*/
 class HazardRecords {
 public:
     using resource = std::span<HazardRecord>;
@@ -143,14 +503,14 @@ public:
     using pointer = typename resource::pointer;
     using const_pointer = typename resource::const_pointer;
 
-    using iterator = pointer;
-    using const_iterator = const_pointer;
-
 public:
-    HazardRecords(resource data) noexcept
-        : data_(data) {
+    HazardRecords(resource data, std::size_t stride = 1) noexcept
+        : data_(data)
+        , stride_(stride) {
         for (std::size_t i = 0; i < data_.size(); ++i) {
             ::new (data_.data() + i) value_type();
+        }
+        for (std::size_t i = 0; i < data_.size(); i += stride_) {
             free_list_.push_front(data_[i]);
         }
     }
@@ -159,22 +519,31 @@ public:
 
     HazardRecords(HazardRecords &&) = delete;
 
+    ~HazardRecords() {
+        auto current = blocks_.load(std::memory_order_relaxed);
+        while (current) {
+            auto next = current->next_;
+            HazardRecordsBlock::destroy(current);
+            current = next;
+        }
+    }
+
 public:
     pointer acquire() noexcept {
-        pointer record{};
         if (!free_list_.empty()) [[likely]] {
-            record = &free_list_.front();
+            pointer record = &free_list_.front();
             free_list_.pop_front();
+            return record;
         }
-        return record;
+        return acquire_overflow();
     }
 
     void release(pointer record) noexcept {
-        assert((data_.data() <= record) && (data_.data() + data_.size() > record)
-               && "Can't release hazard record from other thread");
-        if (record) [[likely]] {
+        if (contains(record)) [[likely]] {
             record->reset();
             free_list_.push_front(*record);
+        } else if (record) {
+            release_overflow(record);
         }
     }
 
@@ -182,38 +551,199 @@ public:
         return free_list_.empty();
     }
 
-    iterator begin() noexcept {
-        return data_.data();
+    bool contains(const_pointer record) const noexcept {
+        return (data_.data() <= record) && (data_.data() + data_.size() > record);
     }
 
-    iterator end() noexcept {
-        return data_.data() + data_.size();
+    /*
+      With a static Extent the records are known to be packed and the loop has a constant trip count.
+    */
+    template<std::size_t Extent = std::dynamic_extent, class Visitor>
+    void visit(Visitor &&visitor) const {
+        if constexpr (Extent == std::dynamic_extent) {
+            for (std::size_t i = 0; i < data_.size(); i += stride_) {
+                visitor(data_[i]);
+            }
+        } else {
+            assert(data_.size() == Extent && stride_ == 1);
+            auto records = data_.data();
+            for (std::size_t i = 0; i < Extent; ++i) {
+                visitor(records[i]);
+            }
+        }
+        auto current = blocks_.load(std::memory_order_acquire);
+        while (current) {
+            if (!current->is_idle()) {
+                current->visit(visitor);
+            }
+            current = current->next_;
+        }
     }
 
-    const_iterator begin() const noexcept {
-        return data_.data();
+private:
+    pointer acquire_overflow() noexcept {
+        auto current = blocks_.load(std::memory_order_relaxed);
+        while (current) {
+            pointer record = current->acquire();
+            if (record) {
+                return record;
+            }
+            current = current->next_;
+        }
+        std::size_t num_of_records = std::max<std::size_t>(data_.size() / stride_, 1);
+        auto new_block = HazardRecordsBlock::create(num_of_records, stride_);
+        if (!new_block) [[unlikely]] {
+            return nullptr;
+        }
+        new_block->next_ = blocks_.load(std::memory_order_relaxed);
+        blocks_.store(new_block, std::memory_order_release);
+        return new_block->acquire();
     }
 
-    const_iterator end() const noexcept {
-        return data_.data() + data_.size();
+    void release_overflow(pointer record) noexcept {
+        auto current = blocks_.load(std::memory_order_relaxed);
+        while (current && !current->contains(record)) {
+            current = current->next_;
+        }
+        assert(current && "Can't release hazard record from other thread");
+        current->release(record);
     }
 
 private:
     resource data_;
-    lu::forward_list<HazardRecord> free_list_{};
+    std::size_t stride_;
+    std::atomic<HazardRecordsBlock *> blocks_{};
+    alignas(CACHE_LINE_SIZE) lu::forward_list<HazardRecord> free_list_{};
+};
+
+/*
+  Contiguous copy of the pointers protected at the moment of a scan. Small snapshots are searched
+  linearly, larger ones are sorted once and searched with binary search.
+*/
+class HazardSnapshot {
+public:
+    using value_type = std::uintptr_t;
+
+    static constexpr std::size_t linear_search_limit = detail::LINEAR_SEARCH_LIMIT;
+
+public:
+    void clear() noexcept {
+        data_.clear();
+    }
+
+    void push(const HazardObject *ptr) {
+        data_.push_back(reinterpret_cast<value_type>(ptr));
+    }
+
+    void push(value_type value) {
+        data_.push_back(value);
+    }
+
+    std::size_t size() const noexcept {
+        return data_.size();
+    }
+
+    void prepare() {
+        if (data_.size() > linear_search_limit) {
+            std::sort(data_.begin(), data_.end());
+        }
+    }
+
+    bool contains(const HazardObject *ptr) const noexcept {
+        auto value = reinterpret_cast<value_type>(ptr);
+        if (data_.size() <= linear_search_limit) {
+            return detail::linear_contains(data_.data(), data_.size(), value);
+        }
+        return std::binary_search(data_.begin(), data_.end(), value);
+    }
+
+    /*
+      Whether any value of the snapshot lies in [first, last].
+    */
+    bool contains_any(value_type first, value_type last) const noexcept {
+        if (data_.size() <= linear_search_limit) {
+            bool found = false;
+            for (auto value: data_) {
+                found |= (first <= value) & (value <= last);
+            }
+            return found;
+        }
+        auto found = std::lower_bound(data_.begin(), data_.end(), first);
+        return found != data_.end() && *found <= last;
+    }
+
+private:
+    std::vector<value_type> data_{};
 };
 
 class HazardThreadData : public lu::thread_local_list_base_hook {
     friend class lu::hazard_pointer_domain;
 
+    friend class lu::hazard_era_domain;
+
 public:
     using records_resource = typename HazardRecords::resource;
     using retires_resource = typename HazardRetires::resource;
 
 public:
-    HazardThreadData(std::size_t scan_threshold, records_resource records_resource, retires_resource retires_resource)
-        : scan_threshold_(scan_threshold)
-        , records_(records_resource)
+    /*
+      Deleters may retire objects of their own (a destroyed value releasing what it owns). While the retired
+      set is walked such objects are put aside and merged when the walk is done, so the walk never sees them.
+      The domain of the walk routes them here even if the thread has no thread data of it any more,
+      as when the destructor of the domain clears orphaned sets.
+    */
+    class ReclaimScope {
+    public:
+        ReclaimScope(const void *domain, HazardThreadData &thread_data) noexcept
+            : domain_(domain)
+            , thread_data_(&thread_data)
+            , prev_(get_current()) {
+            thread_data_->is_reclaiming_ = true;
+            get_current() = this;
+        }
+
+        ReclaimScope(const ReclaimScope &) = delete;
+
+        ReclaimScope &operator=(const ReclaimScope &) = delete;
+
+        ~ReclaimScope() {
+            finish();
+        }
+
+        /*
+          Returns whether anything was retired during the walk.
+        */
+        bool finish() {
+            bool has_deferred = false;
+            if (thread_data_) {
+                get_current() = prev_;
+                thread_data_->is_reclaiming_ = false;
+                if (!thread_data_->deferred_.empty()) [[unlikely]] {
+                    thread_data_->retires_.merge(thread_data_->deferred_);
+                    has_deferred = true;
+                }
+                thread_data_ = nullptr;
+            }
+            return has_deferred;
+        }
+
+    private:
+        friend class HazardThreadData;
+
+        static ReclaimScope *&get_current() noexcept {
+            static thread_local ReclaimScope *current{};
+            return current;
+        }
+
+    private:
+        const void *domain_;
+        HazardThreadData *thread_data_;
+        ReclaimScope *prev_;
+    };
+
+public:
+    HazardThreadData(records_resource records_resource, std::size_t records_stride, retires_resource retires_resource)
+        : records_(records_resource, records_stride)
         , retires_(retires_resource) {}
 
     HazardThreadData(const HazardThreadData &) = delete;
@@ -224,11 +754,25 @@ public:
         clear();
     }
 
-    void clear() {
-        auto current = retires_.begin();
-        while (current != retires_.end()) {
-            auto prev = current++;
-            reclaim(*prev);
+    /*
+      The thread data the calling thread is walking on behalf of the domain, if any.
+    */
+    static HazardThreadData *get_reclaiming(const void *domain) noexcept {
+        auto current = ReclaimScope::get_current();
+        if (current && current->domain_ == domain) [[unlikely]] {
+            return current->thread_data_;
+        }
+        return nullptr;
+    }
+
+    void clear(const void *domain = nullptr) {
+        while (!retires_.empty()) {
+            ReclaimScope scope(domain, *this);
+            auto current = retires_.begin();
+            while (current != retires_.end()) {
+                auto prev = current++;
+                reclaim(*prev);
+            }
         }
     }
 
@@ -238,168 +782,699 @@ public:
         num_of_reclaimed.fetch_add(1, std::memory_order_relaxed);
     }
 
-    bool retire(HazardObject &retired) {
-        retires_.insert(retired);
+    void retire(HazardObject &retired) {
+        get_retires().insert(retired);
         num_of_retired.fetch_add(1, std::memory_order_relaxed);
-        return retires_.size() >= scan_threshold_;
+    }
+
+    template<class Iterator, class Prepare>
+    void retire(Iterator first, Iterator last, Prepare &&prepare) {
+        auto &retires = get_retires();
+        std::size_t count{};
+        for (; first != last; ++first, ++count) {
+            auto retired = lu::to_raw_pointer(*first);
+            prepare(retired);
+            retires.insert(*retired);
+        }
+        num_of_retired.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    std::size_t num_of_retires() const noexcept {
+        return retires_.size();
     }
 
     void merge(HazardThreadData &other) {
         retires_.merge(other.retires_);
     }
 
+    void merge(HazardRetires &retires) {
+        retires_.merge(retires);
+    }
+
     HazardRecord *acquire_record() noexcept {
-        return records_.acquire();
+        auto record = records_.acquire();
+        if (!record) [[unlikely]] {
+            counters_.add_failed_acquire();
+        }
+        return record;
     }
 
     void release_record(HazardRecord *record) noexcept {
         records_.release(record);
     }
 
+    void acquire_records(std::span<HazardRecord *> records) noexcept {
+        for (auto &record: records) {
+            record = acquire_record();
+        }
+    }
+
+    void release_records(std::span<HazardRecord *const> records) noexcept {
+        for (auto record: records) {
+            records_.release(record);
+        }
+    }
+
 private:
-    std::size_t scan_threshold_;
+    HazardRetires &get_retires() noexcept {
+        return is_reclaiming_ ? deferred_ : retires_;
+    }
+
+private:
+    static constexpr std::size_t NUM_OF_DEFERRED_BUCKETS = 8;
+
     HazardRecords records_;
     HazardRetires retires_;
+    HazardSnapshot snapshot_;
+    std::array<typename HazardRetires::bucket_type, NUM_OF_DEFERRED_BUCKETS> deferred_buckets_{};
+    HazardRetires deferred_{deferred_buckets_};
+    bool is_reclaiming_{};
+    [[no_unique_address]] ReclamationCounters<> counters_;
 
     std::atomic<std::size_t> num_of_retired;
     std::atomic<std::size_t> num_of_reclaimed;
+
+    std::size_t num_of_accounted_retired_{};
+    std::size_t num_of_accounted_reclaimed_{};
+};
+
+template<std::size_t NumOfRecords, std::size_t NumOfRetires>
+struct StaticHazardThreadStorage {
+    std::array<HazardRecord, NumOfRecords> records{};
+    std::array<typename HazardRetires::bucket_type, NumOfRetires> buckets{};
+};
+
+/*
+  Thread data with the records and the buckets embedded. The storage is a base that precedes
+  HazardThreadData, so it's constructed before HazardThreadData takes spans over it.
+*/
+template<std::size_t NumOfRecords, std::size_t NumOfRetires>
+class StaticHazardThreadData : private StaticHazardThreadStorage<NumOfRecords, NumOfRetires>,
+                               public HazardThreadData {
+    using Storage = StaticHazardThreadStorage<NumOfRecords, NumOfRetires>;
+
+public:
+    StaticHazardThreadData()
+        : HazardThreadData(records_resource(Storage::records), 1, retires_resource(Storage::buckets)) {}
+};
+
+/*
+  The blob is aligned to a cache line and the records and the buckets start on lines of their own,
+  so records read by scanners never share a line with the buckets or with another thread's blob.
+*/
+struct HazardThreadDataCreator {
+    HazardThreadDataCreator(std::size_t num_of_records, std::size_t num_of_retires, layout_policy layout,
+                            numa_policy numa = numa_policy::none)
+        : num_of_records_(num_of_records)
+        , num_of_retires_(num_of_retires)
+        , records_stride_(get_records_stride(layout))
+        , is_numa_(numa != numa_policy::none) {}
+
+    /*
+      With NUMA the blob takes whole pages of its own, so they can be placed on the node of the thread.
+    */
+    static std::size_t get_blob_align(bool is_numa) noexcept {
+        return is_numa ? NUMA_PAGE_SIZE : CACHE_LINE_SIZE;
+    }
+
+    static std::size_t get_records_stride(layout_policy layout) noexcept {
+        static_assert(CACHE_LINE_SIZE % sizeof(HazardRecord) == 0);
+        if (layout == layout_policy::padded) {
+            return CACHE_LINE_SIZE / sizeof(HazardRecord);
+        }
+        return 1;
+    }
+
+    HazardThreadData *operator()() const {
+        using records_resource = typename HazardThreadData::records_resource;
+        using records_element_type = typename records_resource::element_type;
+
+        using retires_resource = typename HazardThreadData::retires_resource;
+        using retires_element_type = typename retires_resource::element_type;
+
+        std::size_t num_of_records = num_of_records_ * records_stride_;
+
+        std::size_t header_size = align_up(sizeof(HazardThreadData), CACHE_LINE_SIZE);
+        std::size_t records_resource_size = align_up(sizeof(records_element_type) * num_of_records, CACHE_LINE_SIZE);
+        std::size_t retires_resource_size = sizeof(retires_element_type) * num_of_retires_;
+
+        std::size_t size = header_size + records_resource_size + retires_resource_size;
+        std::size_t align = get_blob_align(is_numa_);
+        size = align_up(size, align);
+
+        auto blob = new (std::align_val_t(align)) std::uint8_t[size];
+        if (is_numa_) {
+            Numa::bind(blob, size, Numa::get_home_node());
+        }
+        auto records = reinterpret_cast<records_element_type *>(blob + header_size);
+        auto retires = reinterpret_cast<retires_element_type *>(blob + header_size + records_resource_size);
+
+        records_resource _records_resource(records, num_of_records);
+        retires_resource _retires_resource(retires, num_of_retires_);
+
+        ::new (blob) HazardThreadData(_records_resource, records_stride_, _retires_resource);
+        auto thread_data = reinterpret_cast<HazardThreadData *>(blob);
+
+        return thread_data;
+    }
+
+private:
+    std::size_t num_of_records_;
+    std::size_t num_of_retires_;
+    std::size_t records_stride_;
+    bool is_numa_;
+};
+
+struct HazardThreadDataDeleter {
+    explicit HazardThreadDataDeleter(numa_policy numa = numa_policy::none)
+        : is_numa_(numa != numa_policy::none) {}
+
+    void operator()(HazardThreadData *thread_data) const {
+        thread_data->~HazardThreadData();
+        auto blob = reinterpret_cast<std::uint8_t *>(thread_data);
+        ::operator delete[](blob, std::align_val_t(HazardThreadDataCreator::get_blob_align(is_numa_)));
+    }
+
+private:
+    bool is_numa_;
 };
 
 }// namespace detail
 
 class hazard_pointer_domain {
-    template<class, class>
-    friend class hazard_pointer_obj_base;
+    template<class, class, class>
+    friend class detail::HazardObjectBase;
 
     friend class hazard_pointer;
 
+    template<std::size_t>
+    friend class hazard_pointer_array;
+
     using HazardThreadData = detail::HazardThreadData;
     using HazardObject = detail::HazardObject;
     using HazardRecord = detail::HazardRecord;
+    using HazardRetiresBatch = detail::HazardRetiresBatch;
 
     struct Detacher {
         explicit Detacher(hazard_pointer_domain *domain)
             : domain_(domain) {}
 
-        void operator()(HazardThreadData *) const {
-            domain_->help_scan();
+        void operator()(HazardThreadData *thread_data) const {
+            domain_->orphan(*thread_data);
+        }
+
+    private:
+        hazard_pointer_domain *domain_;
+    };
+
+    using Creator = detail::HazardThreadDataCreator;
+    using Deleter = detail::HazardThreadDataDeleter;
+    using Numa = detail::Numa;
+
+    using ThreadDataList = lu::thread_local_list<HazardThreadData>;
+
+    /*
+      Thread data of the threads of one NUMA node, and the retired objects the node has put together
+      in the hierarchical mode.
+    */
+    struct Partition {
+        template<class ThreadDataCreator, class ThreadDataDeleter>
+        Partition(Detacher detacher, ThreadDataCreator creator, ThreadDataDeleter deleter)
+            : list(std::move(detacher), std::move(creator), std::move(deleter)) {}
+
+        ThreadDataList list;
+        alignas(detail::CACHE_LINE_SIZE) std::atomic<HazardRetiresBatch *> batches{};
+        std::atomic<std::size_t> num_of_batches{};
+    };
+
+public:
+    /*
+      With threshold_policy::adaptive the scan threshold follows the number of attached threads
+      as max(scan_threshold, ADAPTIVE_SCAN_FACTOR * num_of_records * threads), so every scan frees
+      a number of objects proportional to the number of records it has to walk.
+      With layout_policy::padded every hazard record gets a cache line of its own.
+      With numa_policy::local the thread data is split into a partition per NUMA node and placed on
+      the node of its thread, numa_policy::hierarchical also collects the retired objects of a node
+      before they are scanned (see hand_off_to_node()).
+    */
+    hazard_pointer_domain(std::size_t num_of_records, std::size_t num_of_retires, std::size_t scan_threshold,
+                          fence_policy fence = fence_policy::symmetric,
+                          threshold_policy threshold = threshold_policy::fixed,
+                          layout_policy layout = layout_policy::compact, numa_policy numa = numa_policy::none)
+        : num_of_records_(num_of_records)
+        , scan_threshold_(scan_threshold)
+        , is_asymmetric_(fence == fence_policy::asymmetric && detail::AsymmetricFence::is_supported())
+        , is_adaptive_(threshold == threshold_policy::adaptive)
+        , numa_(numa)
+        , scan_func_(&hazard_pointer_domain::scan_impl<std::dynamic_extent>) {
+        auto num_of_partitions = numa == numa_policy::none ? 1 : Numa::get_num_of_nodes();
+        for (std::size_t i = 0; i < num_of_partitions; ++i) {
+            partitions_.push_back(std::make_unique<Partition>(
+                    Detacher(this), Creator(num_of_records, num_of_retires, layout, numa), Deleter(numa)));
+        }
+    }
+
+    hazard_pointer_domain(const hazard_pointer_domain &) = delete;
+
+    hazard_pointer_domain(hazard_pointer_domain &&) = delete;
+
+    /*
+      Everything still retired is reclaimed through the thread data, so the objects the deleters retire
+      on the way are reclaimed as well.
+    */
+    ~hazard_pointer_domain() {
+        stop_reclaimer();
+        for_each_thread_data([this](HazardThreadData &thread_data) {
+            drain_batches(thread_data);
+            for (auto &partition: partitions_) {
+                drain_batches(partition->batches, partition->num_of_batches, thread_data);
+            }
+            thread_data.clear(this);
+        });
+    }
+
+    void attach_thread() {
+        get_local_partition().list.attach_thread();
+    }
+
+    void detach_thread() {
+        get_local_partition().list.detach_thread();
+    }
+
+    /*
+      Adopts everything left retired by other threads, the orphaned batches of detached threads and
+      the retired objects of free thread data, and scans on the calling thread. Blocks for as long as
+      a detaching thread used to.
+    */
+    void cleanup() {
+        auto &thread_data = get_thread_data();
+        drain_batches(thread_data);
+        for (auto &partition: partitions_) {
+            drain_batches(partition->batches, partition->num_of_batches, thread_data);
+        }
+        help_scan();
+    }
+
+    template<class Iterator>
+    void retire_batch(Iterator first, Iterator last) {
+        retire_batch(first, last, [](auto retired) { retired->prepare_retire(); });
+    }
+
+    fence_policy get_fence_policy() const noexcept {
+        return is_asymmetric_ ? fence_policy::asymmetric : fence_policy::symmetric;
+    }
+
+    threshold_policy get_threshold_policy() const noexcept {
+        return is_adaptive_ ? threshold_policy::adaptive : threshold_policy::fixed;
+    }
+
+    numa_policy get_numa_policy() const noexcept {
+        return numa_;
+    }
+
+    std::size_t get_scan_threshold() const noexcept {
+        if (is_adaptive_) {
+            std::size_t num_of_active{};
+            for (auto &partition: partitions_) {
+                num_of_active += partition->list.num_of_active();
+            }
+            auto adaptive = ADAPTIVE_SCAN_FACTOR * num_of_records_ * num_of_active;
+            return std::max(scan_threshold_, adaptive);
+        }
+        return scan_threshold_;
+    }
+
+    /*
+      Starts a thread that takes over scanning and running the deleters. A thread crossing the scan
+      threshold only moves its retired objects into a batch and hands it over, unless the batch can't
+      be allocated.
+    */
+    void start_reclaimer(reclaimer_wakeup wakeup = {}) {
+        std::lock_guard lock(reclaimer_mutex_);
+        assert(!reclaimer_.joinable() && "Reclaimer is already running");
+        wakeup_interval_ = wakeup.interval;
+        wakeup_num_of_batches_.store(wakeup.num_of_batches, std::memory_order_relaxed);
+        is_stopping_ = false;
+        reclaimer_ = std::thread([this] { run_reclaimer(); });
+        has_reclaimer_.store(true, std::memory_order_release);
+    }
+
+    void stop_reclaimer() {
+        std::unique_lock lock(reclaimer_mutex_);
+        if (!reclaimer_.joinable()) {
+            return;
+        }
+        has_reclaimer_.store(false, std::memory_order_relaxed);
+        is_stopping_ = true;
+        reclaimer_wakeup_.notify_all();
+        auto reclaimer = std::move(reclaimer_);
+        lock.unlock();
+        reclaimer.join();
+    }
+
+    bool has_reclaimer() const noexcept {
+        return has_reclaimer_.load(std::memory_order_relaxed);
+    }
+
+    /*
+      Hands over the retired objects of the calling thread and waits until the reclaimer has scanned
+      everything handed over so far. Without a reclaimer that scan runs on the calling thread.
+    */
+    void flush() {
+        auto &thread_data = get_thread_data();
+        if (has_reclaimer() && !is_reclaimer_thread() && thread_data.num_of_retires()) {
+            hand_off(thread_data);
+        }
+        std::unique_lock lock(reclaimer_mutex_);
+        if (reclaimer_.joinable() && !is_stopping_ && !is_reclaimer_thread()) {
+            auto ticket = ++flush_requested_;
+            reclaimer_wakeup_.notify_all();
+            reclaimer_flushed_.wait(lock, [this, ticket] { return flush_completed_ >= ticket; });
+        } else {
+            lock.unlock();
+            drain_batches(thread_data);
+            drain_batches(get_local_partition().batches, get_local_partition().num_of_batches, thread_data);
+            scan();
         }
+    }
 
-    private:
-        hazard_pointer_domain *domain_;
-    };
+    std::size_t num_of_retired() {
+        std::size_t result{};
+        for_each_thread_data([&result](HazardThreadData &thread_data) {
+            result += thread_data.num_of_retired.load(std::memory_order_relaxed);
+        });
+        return result;
+    }
 
-    struct Creator {
-        Creator(std::size_t num_of_records, std::size_t num_of_retires, std::size_t scan_threshold)
-            : num_of_records_(num_of_records)
-            , num_of_retires_(num_of_retires)
-            , scan_threshold_(scan_threshold) {}
+    std::size_t num_of_reclaimed() {
+        std::size_t result{};
+        for_each_thread_data([&result](HazardThreadData &thread_data) {
+            result += thread_data.num_of_reclaimed.load(std::memory_order_relaxed);
+        });
+        return result;
+    }
 
-        HazardThreadData *operator()() const {
-            using records_resource = typename HazardThreadData::records_resource;
-            using records_element_type = typename records_resource::element_type;
+    /*
+      Sums the counters of all thread data, the values of threads that are running are slightly stale.
+    */
+    reclamation_stats get_stats() {
+        reclamation_stats result{};
+        for_each_thread_data([&result](HazardThreadData &thread_data) { thread_data.counters_.collect(result); });
+        result.num_of_pending = num_of_pending();
+        return result;
+    }
 
-            using retires_resource = typename HazardThreadData::retires_resource;
-            using retires_element_type = typename retires_resource::element_type;
+    /*
+      The hook is called by the scanning thread after every scan, so it must be thread safe.
+      It has to be set before the domain is used.
+    */
+    void set_stats_hook(stats_hook hook) {
+        stats_hook_ = std::move(hook);
+    }
+
+    /*
+      Has to be set before the domain is used, like the stats hook. The hook is called by the retiring
+      thread that found the domain over the budget after helping, it must be thread safe.
+    */
+    void set_retire_budget(retire_budget budget, budget_hook hook = {}) {
+        budget_ = budget;
+        budget_hook_ = std::move(hook);
+    }
 
-            std::size_t header_size = sizeof(HazardThreadData);
-            std::size_t records_resource_size = sizeof(records_element_type) * num_of_records_;
-            std::size_t retires_resource_size = sizeof(retires_element_type) * num_of_retires_;
+    retire_budget get_retire_budget() const noexcept {
+        return budget_;
+    }
 
-            std::size_t size = header_size + records_resource_size + retires_resource_size;
+    /*
+      Number of records a scan has to inspect from which it goes through a snapshot of the protected
+      pointers instead of probing the retired set with each of them, zero makes every scan do so.
+      Has to be set before the domain is used, like the stats hook.
+    */
+    void set_snapshot_threshold(std::size_t num_of_records) noexcept {
+        snapshot_threshold_ = num_of_records;
+    }
 
-            auto blob = new std::uint8_t[size];
-            auto records = reinterpret_cast<records_element_type *>(blob + header_size);
-            auto retires = reinterpret_cast<retires_element_type *>(blob + header_size + records_resource_size);
+    std::size_t get_snapshot_threshold() const noexcept {
+        return snapshot_threshold_;
+    }
 
-            records_resource _records_resource(records, num_of_records_);
-            retires_resource _retires_resource(retires, num_of_retires_);
+    /*
+      Objects retired and not reclaimed yet, only counted with a budget set. Every thread publishes its part
+      once per BUDGET_QUANTUM retires and after each scan, so the value is off by up to that much per thread.
+    */
+    std::size_t num_of_pending() const noexcept {
+        return static_cast<std::size_t>(std::max<std::ptrdiff_t>(num_of_pending_.load(std::memory_order_relaxed), 0));
+    }
 
-            ::new (blob) HazardThreadData(scan_threshold_, _records_resource, _retires_resource);
-            auto thread_data = reinterpret_cast<HazardThreadData *>(blob);
+protected:
+    template<std::size_t NumOfRecords, class ThreadDataCreator, class ThreadDataDeleter>
+    hazard_pointer_domain(std::integral_constant<std::size_t, NumOfRecords>, ThreadDataCreator creator,
+                          ThreadDataDeleter deleter, std::size_t scan_threshold, fence_policy fence,
+                          threshold_policy threshold)
+        : num_of_records_(NumOfRecords)
+        , scan_threshold_(scan_threshold)
+        , is_asymmetric_(fence == fence_policy::asymmetric && detail::AsymmetricFence::is_supported())
+        , is_adaptive_(threshold == threshold_policy::adaptive)
+        , numa_(numa_policy::none)
+        , scan_func_(&hazard_pointer_domain::scan_impl<NumOfRecords>) {
+        partitions_.push_back(std::make_unique<Partition>(Detacher(this), std::move(creator), std::move(deleter)));
+    }
 
-            return thread_data;
+private:
+    /*
+      A thread stays in the partition of the node it first ran on.
+    */
+    Partition &get_local_partition() const noexcept {
+        if (partitions_.size() == 1) [[likely]] {
+            return *partitions_.front();
         }
+        return *partitions_[Numa::get_home_node() % partitions_.size()];
+    }
 
-    private:
-        std::size_t num_of_records_;
-        std::size_t num_of_retires_;
-        std::size_t scan_threshold_;
-    };
+    HazardThreadData &get_thread_data() {
+        return get_local_partition().list.get_thread_local();
+    }
 
-    struct Deleter {
-        void operator()(HazardThreadData *thread_data) const {
-            thread_data->~HazardThreadData();
-            delete[] reinterpret_cast<std::uint8_t *>(thread_data);
+    template<class Func>
+    void for_each_thread_data(Func &&func) {
+        for (auto &partition: partitions_) {
+            for (auto &thread_data: partition->list) {
+                func(thread_data);
+            }
         }
-    };
-
-public:
-    hazard_pointer_domain(std::size_t num_of_records, std::size_t num_of_retires, std::size_t scan_threshold)
-        : list_(Detacher(this), Creator(num_of_records, num_of_retires, scan_threshold), Deleter()) {}
+    }
 
-    hazard_pointer_domain(const hazard_pointer_domain &) = delete;
+    /*
+      Visits the records of every attached thread and returns how many it visited. Records in the partitions
+      of other nodes are counted as remote.
+    */
+    template<std::size_t Extent, class Visitor>
+    std::size_t visit_records(HazardThreadData &thread_data, Visitor &&visitor) {
+        auto &local = get_local_partition();
+        std::size_t num_of_inspected{};
+        for (auto &partition: partitions_) {
+            auto num_of_inspected_before = num_of_inspected;
+            for (auto &current: partition->list) {
+                if (!current.is_acquired()) {
+                    continue;
+                }
+                current.records_.template visit<Extent>([&visitor, &num_of_inspected](const HazardRecord &record) {
+                    ++num_of_inspected;
+                    visitor(record);
+                });
+            }
+            if (partition.get() != &local) [[unlikely]] {
+                thread_data.counters_.add_remote_records(num_of_inspected - num_of_inspected_before);
+            }
+        }
+        return num_of_inspected;
+    }
 
-    hazard_pointer_domain(hazard_pointer_domain &&) = delete;
+    void retire(HazardObject *retired) {
+        if (auto reclaiming = HazardThreadData::get_reclaiming(this)) [[unlikely]] {
+            reclaiming->retire(*retired);
+            return;
+        }
+        auto &thread_data = get_thread_data();
+        thread_data.retire(*retired);
+        if (thread_data.num_of_retires() >= get_scan_threshold()) [[unlikely]] {
+            scan_or_hand_off(thread_data);
+        }
+        if (budget_.max_pending) [[unlikely]] {
+            check_budget(thread_data);
+        }
+    }
 
-    void attach_thread() {
-        list_.attach_thread();
+    template<class Iterator, class Prepare>
+    void retire_batch(Iterator first, Iterator last, Prepare &&prepare) {
+        if (first == last) {
+            return;
+        }
+        if (auto reclaiming = HazardThreadData::get_reclaiming(this)) [[unlikely]] {
+            reclaiming->retire(first, last, std::forward<Prepare>(prepare));
+            return;
+        }
+        auto &thread_data = get_thread_data();
+        thread_data.retire(first, last, std::forward<Prepare>(prepare));
+        if (thread_data.num_of_retires() >= get_scan_threshold()) [[unlikely]] {
+            scan_or_hand_off(thread_data);
+        }
+        if (budget_.max_pending) [[unlikely]] {
+            check_budget(thread_data);
+        }
     }
 
-    void detach_thread() {
-        list_.detach_thread();
+    bool is_over_budget() const noexcept {
+        return num_of_pending() > budget_.max_pending;
     }
 
-    std::size_t num_of_retired() {
-        std::size_t result{};
-        for (auto it = list_.begin(); it != list_.end(); ++it) {
-            result += it->num_of_retired.load(std::memory_order_relaxed);
+    void check_budget(HazardThreadData &thread_data) {
+        if (!account_retired(thread_data) || !is_over_budget()) [[likely]] {
+            return;
+        }
+        thread_data.counters_.add_over_budget();
+        scan();
+        if (!is_over_budget()) {
+            return;
+        }
+        cleanup();
+        while (is_over_budget() && thread_data.num_of_retires() >= detail::BUDGET_QUANTUM) {
+            if (budget_.policy == budget_policy::callback) {
+                if (budget_hook_) {
+                    budget_hook_(num_of_pending());
+                }
+                return;
+            }
+            std::this_thread::yield();
+            cleanup();
         }
-        return result;
     }
 
-    std::size_t num_of_reclaimed() {
-        std::size_t result{};
-        for (auto it = list_.begin(); it != list_.end(); ++it) {
-            result += it->num_of_reclaimed.load(std::memory_order_relaxed);
+    /*
+      Returns whether the retires of the thread data were published.
+    */
+    bool account_retired(HazardThreadData &thread_data, std::size_t quantum = detail::BUDGET_QUANTUM) noexcept {
+        auto num_of_retired = thread_data.num_of_retired.load(std::memory_order_relaxed);
+        auto count = num_of_retired - thread_data.num_of_accounted_retired_;
+        if (count < quantum) [[likely]] {
+            return false;
         }
-        return result;
+        thread_data.num_of_accounted_retired_ = num_of_retired;
+        num_of_pending_.fetch_add(static_cast<std::ptrdiff_t>(count), std::memory_order_relaxed);
+        return true;
     }
 
-private:
-    void retire(HazardObject *retired) {
-        auto &thread_data = list_.get_thread_local();
-        if (thread_data.retire(*retired)) [[unlikely]] {
-            scan();
-        }
+    void account_reclaimed(HazardThreadData &thread_data) noexcept {
+        auto num_of_reclaimed = thread_data.num_of_reclaimed.load(std::memory_order_relaxed);
+        auto count = num_of_reclaimed - thread_data.num_of_accounted_reclaimed_;
+        thread_data.num_of_accounted_reclaimed_ = num_of_reclaimed;
+        num_of_pending_.fetch_sub(static_cast<std::ptrdiff_t>(count), std::memory_order_relaxed);
     }
 
     HazardRecord *acquire_record() noexcept {
-        auto &thread_data = list_.get_thread_local();
+        auto &thread_data = get_thread_data();
         return thread_data.acquire_record();
     }
 
     void release_record(HazardRecord *record) noexcept {
-        auto &thread_data = list_.get_thread_local();
+        auto &thread_data = get_thread_data();
         thread_data.release_record(record);
     }
 
+    /*
+      The records of a hazard_pointer_array are taken and given back with one lookup of the thread data.
+    */
+    void acquire_records(std::span<HazardRecord *> records) noexcept {
+        auto &thread_data = get_thread_data();
+        thread_data.acquire_records(records);
+    }
+
+    void release_records(std::span<HazardRecord *const> records) noexcept {
+        auto &thread_data = get_thread_data();
+        thread_data.release_records(records);
+    }
+
+    inline void protection_fence() const noexcept {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::light();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void scan_fence() const {
+        if (is_asymmetric_) {
+            detail::AsymmetricFence::heavy();
+        } else {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    /*
+      With few records probing the retired set with each protected pointer is the cheapest way to find
+      the protected objects. Once the attached threads have snapshot_threshold_ records between them,
+      or the retired set is overloaded (its buckets couldn't grow), the protected pointers are copied
+      into a contiguous snapshot and every retired object is searched there instead. Records of overflow
+      blocks aren't counted.
+    */
     void scan() {
-        auto &thread_data = list_.get_thread_local();
+        (this->*scan_func_)();
+    }
+
+    bool is_snapshot_scan(const detail::HazardRetires &retires) const noexcept {
+        if (retires.size() > retires.bucket_count()) [[unlikely]] {
+            return true;
+        }
+        std::size_t num_of_active{};
+        for (auto &partition: partitions_) {
+            num_of_active += partition->list.num_of_active();
+        }
+        return num_of_active * num_of_records_ >= snapshot_threshold_;
+    }
+
+    /*
+      Objects retired by the deleters during a pass are only covered by the next one, so passes are
+      repeated until none are left. That is how a chain of objects owning each other gets unrolled.
+    */
+    template<std::size_t Extent>
+    void scan_impl() {
+        auto &thread_data = get_thread_data();
         auto &retires = thread_data.retires_;
-        std::atomic_thread_fence(std::memory_order_seq_cst);
-        for (auto current = list_.begin(); current != list_.end(); ++current) {
-            if (!current->is_acquired()) {
-                continue;
+        bool has_deferred = true;
+        while (has_deferred) {
+            auto num_of_scanned = retires.size();
+            auto start = thread_data.counters_.start_scan(num_of_scanned);
+            scan_fence();
+            HazardThreadData::ReclaimScope scope(this, thread_data);
+            std::size_t num_of_inspected{};
+            if (is_snapshot_scan(retires)) {
+                num_of_inspected = scan_snapshot<Extent>(thread_data);
+            } else {
+                num_of_inspected = scan_probe<Extent>(thread_data);
+            }
+            auto sample = thread_data.counters_.finish_scan(start, num_of_inspected, num_of_scanned, retires.size());
+            has_deferred = scope.finish();
+            retires.shrink_to_fit();
+            if (budget_.max_pending) [[unlikely]] {
+                account_reclaimed(thread_data);
             }
-            auto &records = current->records_;
-            for (auto record = records.begin(); record != records.end(); ++record) {
-                auto found = retires.find(record->get());
-                if (found != retires.end()) {
-                    found->make_protected();
+            if constexpr (detail::STATS_ENABLED) {
+                if (stats_hook_) {
+                    stats_hook_(sample);
                 }
             }
         }
+    }
+
+    template<std::size_t Extent>
+    std::size_t scan_probe(HazardThreadData &thread_data) {
+        auto &retires = thread_data.retires_;
+        auto num_of_inspected = visit_records<Extent>(thread_data, [&retires](const HazardRecord &record) {
+            auto found = retires.find(record.get());
+            if (found != retires.end()) {
+                found->make_protected();
+            }
+        });
 
         auto current = retires.begin();
         while (current != retires.end()) {
@@ -410,27 +1485,257 @@ private:
                 thread_data.reclaim(*prev);
             }
         }
+        return num_of_inspected;
+    }
+
+    template<std::size_t Extent>
+    std::size_t scan_snapshot(HazardThreadData &thread_data) {
+        auto &retires = thread_data.retires_;
+        auto &snapshot = thread_data.snapshot_;
+        snapshot.clear();
+        auto num_of_inspected = visit_records<Extent>(thread_data, [&snapshot](const HazardRecord &record) {
+            auto protected_ptr = record.get();
+            if (protected_ptr) {
+                snapshot.push(protected_ptr);
+            }
+        });
+        snapshot.prepare();
+
+        auto current = retires.begin();
+        while (current != retires.end()) {
+            auto prev = current++;
+            if (!snapshot.contains(prev.operator->())) {
+                thread_data.reclaim(*prev);
+            }
+        }
+        return num_of_inspected;
     }
 
     void help_scan() {
-        auto &thread_data = list_.get_thread_local();
-        for (auto current = list_.begin(); current != list_.end(); ++current) {
-            if (current->try_acquire()) {
-                thread_data.merge(*current);
-                current->release();
+        auto &thread_data = get_thread_data();
+        auto num_of_retires = thread_data.num_of_retires();
+        for_each_thread_data([&thread_data](HazardThreadData &other) {
+            if (other.try_acquire()) {
+                thread_data.merge(other);
+                other.release();
+            }
+        });
+        thread_data.counters_.add_merged_orphans(thread_data.num_of_retires() - num_of_retires);
+        scan();
+    }
+
+    static const hazard_pointer_domain *&get_reclaimer_domain() noexcept {
+        static thread_local const hazard_pointer_domain *domain{};
+        return domain;
+    }
+
+    bool is_reclaimer_thread() const noexcept {
+        return get_reclaimer_domain() == this;
+    }
+
+    /*
+      Without a reclaimer the batches left by detached threads are adopted by the next scan.
+    */
+    void scan_or_hand_off(HazardThreadData &thread_data) {
+        if (has_reclaimer_.load(std::memory_order_acquire) && !is_reclaimer_thread()) [[likely]] {
+            if (hand_off(thread_data)) [[likely]] {
+                return;
+            }
+        }
+        if (numa_ == numa_policy::hierarchical && !is_reclaimer_thread()) {
+            if (hand_off_to_node(thread_data)) {
+                return;
             }
         }
+        if (batches_.load(std::memory_order_relaxed)) [[unlikely]] {
+            drain_batches(thread_data);
+        }
         scan();
     }
 
+    /*
+      A thread crossing the threshold adds its retired objects to the batches of its node, the one that
+      makes it a batch per attached thread of the node takes them all and scans. Records of the other
+      nodes are read once per round of the node instead of once per thread, in exchange up to
+      threads * threshold objects of a node wait for the scan.
+    */
+    bool hand_off_to_node(HazardThreadData &thread_data) {
+        auto &partition = get_local_partition();
+        auto num_of_batches = partition.num_of_batches.load(std::memory_order_relaxed);
+        if (num_of_batches + 1 >= partition.list.num_of_active()) {
+            drain_batches(partition.batches, partition.num_of_batches, thread_data);
+            return false;
+        }
+        auto batch = HazardRetiresBatch::create(thread_data.retires_);
+        if (!batch) [[unlikely]] {
+            return false;
+        }
+        push_batch(partition.batches, batch);
+        partition.num_of_batches.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*
+      A detaching thread doesn't scan: what it has left retired is moved into a batch, like a hand off
+      to the reclaimer. A batch that can't be allocated leaves the thread with the old blocking scan.
+    */
+    void orphan(HazardThreadData &thread_data) {
+        if (budget_.max_pending) [[unlikely]] {
+            account_retired(thread_data, 1);
+        }
+        if (numa_ == numa_policy::hierarchical) {
+            auto &partition = get_local_partition();
+            drain_batches(partition.batches, partition.num_of_batches, thread_data);
+        }
+        if (!thread_data.num_of_retires()) {
+            return;
+        }
+        if (!hand_off(thread_data)) [[unlikely]] {
+            help_scan();
+        }
+    }
+
+    bool hand_off(HazardThreadData &thread_data) {
+        thread_data.counters_.update_peak_backlog(thread_data.num_of_retires());
+        auto batch = HazardRetiresBatch::create(thread_data.retires_);
+        if (!batch) [[unlikely]] {
+            return false;
+        }
+        push_batch(batches_, batch);
+
+        auto num_of_batches = num_of_batches_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (num_of_batches == wakeup_num_of_batches_.load(std::memory_order_relaxed)) {
+            std::lock_guard lock(reclaimer_mutex_);
+            reclaimer_wakeup_.notify_one();
+        }
+        return true;
+    }
+
+    static void push_batch(std::atomic<HazardRetiresBatch *> &batches, HazardRetiresBatch *batch) noexcept {
+        batch->next_ = batches.load(std::memory_order_relaxed);
+        while (!batches.compare_exchange_weak(batch->next_, batch, std::memory_order_release,
+                                              std::memory_order_relaxed)) {}
+    }
+
+    static void drain_batches(std::atomic<HazardRetiresBatch *> &batches, std::atomic<std::size_t> &num_of_batches,
+                              HazardThreadData &thread_data) {
+        num_of_batches.store(0, std::memory_order_relaxed);
+        auto batch = batches.exchange(nullptr, std::memory_order_acquire);
+        while (batch) {
+            auto next = batch->next_;
+            thread_data.merge(batch->retires_);
+            HazardRetiresBatch::destroy(batch);
+            batch = next;
+        }
+    }
+
+    void drain_batches(HazardThreadData &thread_data) {
+        drain_batches(batches_, num_of_batches_, thread_data);
+    }
+
+    void run_reclaimer() {
+        get_reclaimer_domain() = this;
+        auto &thread_data = get_thread_data();
+
+        std::unique_lock lock(reclaimer_mutex_);
+        while (true) {
+            reclaimer_wakeup_.wait_for(lock, wakeup_interval_, [this] {
+                auto wakeup_num_of_batches = wakeup_num_of_batches_.load(std::memory_order_relaxed);
+                return is_stopping_ || flush_requested_ != flush_completed_
+                       || (wakeup_num_of_batches
+                           && num_of_batches_.load(std::memory_order_relaxed) >= wakeup_num_of_batches);
+            });
+            bool is_stopping = is_stopping_;
+            auto flush_ticket = flush_requested_;
+            lock.unlock();
+
+            drain_batches(thread_data);
+            if (thread_data.num_of_retires()) {
+                scan();
+            }
+
+            lock.lock();
+            flush_completed_ = flush_ticket;
+            reclaimer_flushed_.notify_all();
+            if (is_stopping) {
+                break;
+            }
+        }
+        lock.unlock();
+
+        detach_thread();
+        get_reclaimer_domain() = nullptr;
+    }
+
 private:
-    lu::thread_local_list<HazardThreadData> list_;
+    static constexpr std::size_t ADAPTIVE_SCAN_FACTOR = 2;
+    static constexpr std::size_t DEFAULT_SNAPSHOT_THRESHOLD = 256;
+
+    const std::size_t num_of_records_;
+    const std::size_t scan_threshold_;
+    const bool is_asymmetric_;
+    const bool is_adaptive_;
+    const numa_policy numa_;
+    void (hazard_pointer_domain::*const scan_func_)();
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    stats_hook stats_hook_{};
+    retire_budget budget_{};
+    budget_hook budget_hook_{};
+    std::size_t snapshot_threshold_{DEFAULT_SNAPSHOT_THRESHOLD};
+    alignas(detail::CACHE_LINE_SIZE) std::atomic<std::ptrdiff_t> num_of_pending_{};
+
+    std::atomic<HazardRetiresBatch *> batches_{};
+    std::atomic<std::size_t> num_of_batches_{};
+    std::atomic<std::size_t> wakeup_num_of_batches_{};
+    std::atomic<bool> has_reclaimer_{};
+
+    std::mutex reclaimer_mutex_{};
+    std::condition_variable reclaimer_wakeup_{};
+    std::condition_variable reclaimer_flushed_{};
+    std::chrono::milliseconds wakeup_interval_{};
+    std::size_t flush_requested_{};
+    std::size_t flush_completed_{};
+    bool is_stopping_{};
+    std::thread reclaimer_{};
 };
 
 static constexpr std::size_t DEFAULT_NUM_OF_RECORDS = 8;
 static constexpr std::size_t DEFAULT_NUM_OF_RETIRES = 64;
 static constexpr std::size_t DEFAULT_SCAN_THRESHOLD = 64;
 
+/*
+  Domain with the number of records and buckets fixed at compile time. Records and buckets are embedded
+  into the thread data instead of being carved out of a blob, and scan() walks the records of each thread
+  with a constant trip count.
+*/
+template<std::size_t NumOfRecords = DEFAULT_NUM_OF_RECORDS, std::size_t NumOfRetires = DEFAULT_NUM_OF_RETIRES,
+         std::size_t ScanThreshold = DEFAULT_SCAN_THRESHOLD>
+class static_hazard_pointer_domain : public hazard_pointer_domain {
+    static_assert(NumOfRecords > 0, "Number of records must be positive");
+    static_assert(NumOfRetires > 0 && !(NumOfRetires & (NumOfRetires - 1)), "Number of retires must be a power of 2");
+
+    using HazardThreadData = detail::HazardThreadData;
+    using StaticHazardThreadData = detail::StaticHazardThreadData<NumOfRecords, NumOfRetires>;
+
+    struct Creator {
+        HazardThreadData *operator()() const {
+            return new StaticHazardThreadData();
+        }
+    };
+
+    struct Deleter {
+        void operator()(HazardThreadData *thread_data) const {
+            delete static_cast<StaticHazardThreadData *>(thread_data);
+        }
+    };
+
+public:
+    explicit static_hazard_pointer_domain(fence_policy fence = fence_policy::symmetric,
+                                          threshold_policy threshold = threshold_policy::fixed)
+        : hazard_pointer_domain(std::integral_constant<std::size_t, NumOfRecords>{}, Creator(), Deleter(),
+                                ScanThreshold, fence, threshold) {}
+};
+
 inline hazard_pointer_domain &get_default_domain() {
     static hazard_pointer_domain domain(DEFAULT_NUM_OF_RECORDS, DEFAULT_NUM_OF_RETIRES, DEFAULT_SCAN_THRESHOLD);
     return domain;
@@ -444,10 +1749,21 @@ inline void detach_thread(hazard_pointer_domain &domain = get_default_domain())
     domain.detach_thread();
 }
 
+inline void cleanup(hazard_pointer_domain &domain = get_default_domain()) {
+    domain.cleanup();
+}
+
 class hazard_pointer {
+    template<std::size_t>
+    friend class hazard_pointer_array;
+
     using HazardObject = detail::HazardObject;
     using HazardRecord = detail::HazardRecord;
 
+    hazard_pointer(hazard_pointer_domain *domain, HazardRecord *record) noexcept
+        : domain_(domain)
+        , record_(record) {}
+
 public:
     hazard_pointer() = default;
 
@@ -526,7 +1842,7 @@ public:
     void reset_protection(const Ptr ptr) noexcept {
         assert(!empty() && "hazard_ptr must be initialized");
         record_->reset(ptr);
-        std::atomic_thread_fence(std::memory_order_seq_cst);
+        domain_->protection_fence();
     }
 
     void reset_protection(nullptr_t = nullptr) noexcept {
@@ -552,6 +1868,101 @@ inline hazard_pointer make_hazard_pointer(hazard_pointer_domain &domain = get_de
     return hazard_pointer(&domain);
 }
 
+/*
+  N guards taken from the thread's records at once and given back at once by the destructor. A guard
+  can be moved out, e.g. into a guarded_ptr, the array then skips it. Swapping or rotating guards
+  hands the protection over without touching the records, which is how a traversal moves forward.
+*/
+template<std::size_t N>
+class hazard_pointer_array {
+    using HazardRecord = detail::HazardRecord;
+
+public:
+    static_assert(N > 0);
+
+    hazard_pointer_array() = default;
+
+    explicit hazard_pointer_array(hazard_pointer_domain *domain) noexcept
+        : domain_(domain) {
+        std::array<HazardRecord *, N> records;
+        domain_->acquire_records(records);
+        for (std::size_t i = 0; i < N; ++i) {
+            guards_[i] = hazard_pointer(domain_, records[i]);
+        }
+    }
+
+    hazard_pointer_array(const hazard_pointer_array &) = delete;
+
+    hazard_pointer_array(hazard_pointer_array &&other) noexcept = default;
+
+    hazard_pointer_array &operator=(const hazard_pointer_array &) = delete;
+
+    hazard_pointer_array &operator=(hazard_pointer_array &&other) noexcept {
+        hazard_pointer_array temp(std::move(other));
+        swap(temp);
+        return *this;
+    }
+
+    ~hazard_pointer_array() {
+        std::array<HazardRecord *, N> records;
+        std::size_t num_of_records = 0;
+        for (auto &guard: guards_) {
+            if (guard.record_ && guard.domain_ == domain_) {
+                records[num_of_records++] = std::exchange(guard.record_, nullptr);
+            }
+        }
+        if (num_of_records) {
+            domain_->release_records(std::span<HazardRecord *const>(records.data(), num_of_records));
+        }
+    }
+
+public:
+    static constexpr std::size_t size() noexcept {
+        return N;
+    }
+
+    hazard_pointer &operator[](std::size_t index) noexcept {
+        assert(index < N);
+        return guards_[index];
+    }
+
+    const hazard_pointer &operator[](std::size_t index) const noexcept {
+        assert(index < N);
+        return guards_[index];
+    }
+
+    /*
+      The guard at i takes over the protection of the guard at i + 1 and the first one becomes the last.
+    */
+    void rotate() noexcept {
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            guards_[i].swap(guards_[i + 1]);
+        }
+    }
+
+    void swap(std::size_t left, std::size_t right) noexcept {
+        guards_[left].swap(guards_[right]);
+    }
+
+    void swap(hazard_pointer_array &other) noexcept {
+        std::swap(domain_, other.domain_);
+        guards_.swap(other.guards_);
+    }
+
+    friend void swap(hazard_pointer_array &left, hazard_pointer_array &right) noexcept {
+        left.swap(right);
+    }
+
+private:
+    hazard_pointer_domain *domain_{};
+    std::array<hazard_pointer, N> guards_{};
+};
+
+template<std::size_t N>
+hazard_pointer_array<N> make_hazard_pointer_array(hazard_pointer_domain &domain = get_default_domain()) {
+    return hazard_pointer_array<N>(&domain);
+}
+
 template<class ValueType>
 class guarded_ptr {
 public:
@@ -599,51 +2010,110 @@ private:
 
 namespace detail {
 
+/*
+  A stateless deleter takes no space in the object.
+*/
 template<class ValueType, class Deleter>
-class HazardPointerDeleter {
+class HazardPointerDeleter : private EmptyBaseHolder<Deleter> {
+    using DeleterHolder = EmptyBaseHolder<Deleter>;
+
 protected:
     void set_deleter(Deleter deleter) noexcept(std::is_nothrow_move_assignable_v<Deleter>) {
-        deleter_ = std::move(deleter);
+        DeleterHolder::get() = std::move(deleter);
     }
 
     void do_delete(ValueType *value) {
-        deleter_(value);
+        DeleterHolder::get()(value);
     }
-
-private:
-    Deleter deleter_;
 };
 
-}// namespace detail
+/*
+  Retire interface over an object header, Header is HazardEraObject or the compact HazardObject.
+  A retired object is recognized by its reclaimer, so a double retire is caught without a flag.
+*/
+template<class ValueType, class Deleter, class Header>
+class HazardObjectBase : public Header, private HazardPointerDeleter<ValueType, Deleter> {
+    friend class lu::hazard_pointer_domain;
+
+    friend class lu::epoch_domain;
+
+    friend class lu::hazard_era_domain;
+
+    using ReclaimFuncPtr = typename HazardObject::ReclaimFuncPtr;
 
-template<class ValueType, class Deleter = std::default_delete<ValueType>>
-class hazard_pointer_obj_base : public detail::HazardObject, private detail::HazardPointerDeleter<ValueType, Deleter> {
 protected:
-    hazard_pointer_obj_base() noexcept = default;
+    HazardObjectBase() noexcept = default;
 
-    hazard_pointer_obj_base(const hazard_pointer_obj_base &) noexcept = default;
+    HazardObjectBase(const HazardObjectBase &) noexcept = default;
 
-    hazard_pointer_obj_base(hazard_pointer_obj_base &&) noexcept = default;
+    HazardObjectBase(HazardObjectBase &&) noexcept = default;
 
 public:
-    void retire(Deleter deleter = Deleter(), hazard_pointer_domain &domain = get_default_domain()) noexcept {
-        assert(!retired_.exchange(true, std::memory_order_relaxed) && "Double retire is not allowed");
-        this->set_deleter(std::move(deleter));
-        this->set_reclaimer(reclaim_func);
+    /*
+      Domain is any reclamation domain (hazard_pointer_domain, epoch_domain, ...), so the same object
+      type can be used with either scheme.
+    */
+    template<class Domain = hazard_pointer_domain>
+    void retire(Deleter deleter = Deleter(), Domain &domain = get_default_domain()) noexcept {
+        prepare_retire(std::move(deleter));
         domain.retire(this);
     }
 
+    /*
+      Retires a range of already unlinked objects at once: the thread data is looked up once
+      and the scan threshold is checked once for the whole range instead of once per object.
+    */
+    template<class Iterator, class Domain = hazard_pointer_domain>
+    static void retire_batch(Iterator first, Iterator last, const Deleter &deleter = Deleter(),
+                             Domain &domain = get_default_domain()) {
+        domain.retire_batch(first, last, [&deleter](HazardObjectBase *retired) { retired->prepare_retire(deleter); });
+    }
+
+private:
+    void prepare_retire(Deleter deleter = Deleter()) noexcept {
+        assert(!this->is_retired() && "Double retire is not allowed");
+        this->set_deleter(std::move(deleter));
+        this->set_reclaimer(&reclaimer);
+    }
+
 private:
     static void reclaim_func(HazardObject *obj) {
-        auto obj_base = static_cast<hazard_pointer_obj_base<ValueType, Deleter> *>(obj);
+        auto obj_base = static_cast<HazardObjectBase *>(obj);
         auto value = static_cast<ValueType *>(obj);
         obj_base->do_delete(value);
     }
 
-#ifndef NDEBUG
-private:
-    std::atomic<bool> retired_{false};
-#endif
+    static constexpr ReclaimFuncPtr reclaimer = &reclaim_func;
+};
+
+}// namespace detail
+
+/*
+  Works with every domain.
+*/
+template<class ValueType, class Deleter = std::default_delete<ValueType>>
+class hazard_pointer_obj_base : public detail::HazardObjectBase<ValueType, Deleter, detail::HazardEraObject> {
+protected:
+    hazard_pointer_obj_base() noexcept = default;
+
+    hazard_pointer_obj_base(const hazard_pointer_obj_base &) noexcept = default;
+
+    hazard_pointer_obj_base(hazard_pointer_obj_base &&) noexcept = default;
+};
+
+/*
+  Header without the eras: the retire hook and the reclaimer, 24 bytes on 64-bit targets with a
+  stateless deleter. Works with hazard_pointer_domain and epoch_domain, retiring it to a
+  hazard_era_domain doesn't compile.
+*/
+template<class ValueType, class Deleter = std::default_delete<ValueType>>
+class compact_hazard_pointer_obj_base : public detail::HazardObjectBase<ValueType, Deleter, detail::HazardObject> {
+protected:
+    compact_hazard_pointer_obj_base() noexcept = default;
+
+    compact_hazard_pointer_obj_base(const compact_hazard_pointer_obj_base &) noexcept = default;
+
+    compact_hazard_pointer_obj_base(compact_hazard_pointer_obj_base &&) noexcept = default;
 };
 
 }// namespace lu
@@ -555,16 +555,16 @@ class IntrusiveHashtable : private EmptyBaseHolder<ValueTraits>,
                            private EmptyBaseHolder<KeyOfValue>,
                            private EmptyBaseHolder<KeyHash>,
                            private EmptyBaseHolder<KeyEqual>,
-                           private EmptyBaseHolder<SizeTraits<SizeType, !ValueTraits::is_auto_unlink>> {
+                           private EmptyBaseHolder<detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>> {
 private:
     using ValueTraitsHolder = EmptyBaseHolder<ValueTraits>;
     using BucketTraitsHolder = EmptyBaseHolder<BucketTraits>;
     using KeyOfValueHolder = EmptyBaseHolder<KeyOfValue>;
     using KeyHashHolder = EmptyBaseHolder<KeyHash>;
     using KeyEqualHolder = EmptyBaseHolder<KeyEqual>;
-    using SizeTraitsHolder = EmptyBaseHolder<SizeTraits<SizeType, !ValueTraits::is_auto_unlink>>;
+    using SizeTraitsHolder = EmptyBaseHolder<detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>>;
 
-    using SizeTraits = SizeTraits<SizeType, !ValueTraits::is_auto_unlink>;
+    using SizeTraits = detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>;
     using Algo = HashtableAlgo<typename ValueTraits::node_traits>;
 
 public:
@@ -967,7 +967,6 @@ public:
 
         node_ptr current = GetFirst();
         Algo::init(GetNilPtr());
-        SizeTraitsHolder::get().set_size(0);
 
         while (current) {
             node_ptr next = node_traits::get_next(current);
@@ -1077,6 +1076,22 @@ public:
         return _bucket_traits.size();
     }
 
+    float load_factor() const noexcept {
+        return static_cast<float>(size()) / static_cast<float>(bucket_count());
+    }
+
+    static size_type suggested_upper_bucket_count(size_type count) noexcept {
+        if constexpr (Flags::is_power_2_buckets) {
+            size_type result = 1;
+            while (result < count) {
+                result <<= 1;
+            }
+            return result;
+        } else {
+            return count;
+        }
+    }
+
     size_type bucket_size(size_type bucket_index) const noexcept {
         size_type size = 0;
         for (const_local_iterator it = begin(bucket_index); it != end(bucket_index); ++it) {
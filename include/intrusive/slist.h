@@ -367,12 +367,12 @@ private:
 
 template<class ValueTraits, class SizeType>
 class IntrusiveSlist : private EmptyBaseHolder<ValueTraits>,
-                       private EmptyBaseHolder<SizeTraits<SizeType, !ValueTraits::is_auto_unlink>> {
+                       private EmptyBaseHolder<detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>> {
 private:
     using ValueTraitsHolder = EmptyBaseHolder<ValueTraits>;
-    using SizeTraitsHolder = EmptyBaseHolder<SizeTraits<SizeType, !ValueTraits::is_auto_unlink>>;
+    using SizeTraitsHolder = EmptyBaseHolder<detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>>;
 
-    using SizeTraits = SizeTraits<SizeType, !ValueTraits::is_auto_unlink>;
+    using SizeTraits = detail::SizeTraits<SizeType, !ValueTraits::is_auto_unlink>;
     using Algo = CircularSlistAlgo<typename ValueTraits::node_traits>;
 
 public:
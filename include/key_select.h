@@ -0,0 +1,33 @@
+#ifndef __KEY_SELECT_H__
+#define __KEY_SELECT_H__
+
+#include <type_traits>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+template<class KeyType, class ValueType>
+struct MapKeySelect {
+    using type = KeyType;
+
+    const KeyType &operator()(const std::pair<KeyType, ValueType> &value) {
+        return value.first;
+    }
+};
+
+template<class KeyType>
+struct SetKeySelect {
+    using type = KeyType;
+
+    template<class T, class = std::enable_if_t<std::is_same_v<std::decay_t<T>, KeyType>>>
+    T &&operator()(T &&value) {
+        return std::forward<T>(value);
+    }
+};
+
+}// namespace detail
+}// namespace lu
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __LINEAR_SEARCH_H__
+#define __LINEAR_SEARCH_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace lu {
+namespace detail {
+
+/*
+  Size up to which linear_contains() beats a binary search over the same values sorted.
+*/
+#if defined(__AVX2__) && (UINTPTR_MAX == UINT64_MAX)
+static constexpr std::size_t LINEAR_SEARCH_LIMIT = 256;
+#else
+static constexpr std::size_t LINEAR_SEARCH_LIMIT = 64;
+#endif
+
+/*
+  Membership test over a small unsorted array of pointer values. The vector paths compare
+  a whole chunk against the value and branch once per chunk, the tail is handled by the scalar loop.
+*/
+inline bool linear_contains(const std::uintptr_t *data, std::size_t size, std::uintptr_t value) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__) && (UINTPTR_MAX == UINT64_MAX)
+    const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(value));
+    for (; i + 8 <= size; i += 8) {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 4));
+        __m256i found = _mm256_or_si256(_mm256_cmpeq_epi64(first, needle), _mm256_cmpeq_epi64(second, needle));
+        if (!_mm256_testz_si256(found, found)) {
+            return true;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint64x2_t needle = vdupq_n_u64(static_cast<std::uint64_t>(value));
+    auto chunk = reinterpret_cast<const std::uint64_t *>(data);
+    for (; i + 4 <= size; i += 4) {
+        uint64x2_t first = vceqq_u64(vld1q_u64(chunk + i), needle);
+        uint64x2_t second = vceqq_u64(vld1q_u64(chunk + i + 2), needle);
+        uint64x2_t found = vorrq_u64(first, second);
+        if (vmaxvq_u32(vreinterpretq_u32_u64(found))) {
+            return true;
+        }
+    }
+#else
+    for (; i + 4 <= size; i += 4) {
+        bool found = (data[i] == value) | (data[i + 1] == value) | (data[i + 2] == value) | (data[i + 3] == value);
+        if (found) {
+            return true;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (data[i] == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}// namespace detail
+}// namespace lu
+
+#endif
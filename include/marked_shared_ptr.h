@@ -179,12 +179,12 @@ struct MarkedSharedPointerTraits {
         return ref_count_ptr(control_block);
     }
 
-    static void dec_ref(control_block_ptr control_block) {
-        control_block->DecRef();
+    static void dec_ref(control_block_ptr control_block, std::int64_t num = 1) {
+        control_block->DecRef(num);
     }
 
-    static void inc_ref(control_block_ptr control_block) {
-        control_block->IncRef();
+    static void inc_ref(control_block_ptr control_block, std::int64_t num = 1) {
+        control_block->IncRef(num);
     }
 
     static bool inc_ref_if_not_zero(control_block_ptr control_block) {
@@ -197,6 +197,18 @@ struct MarkedSharedPointerTraits {
 template<class ValueType>
 using atomic_marked_shared_ptr = detail::AtomicRefCountPointer<detail::MarkedSharedPointerTraits<ValueType>>;
 
+/*
+  Returned by atomic_marked_shared_ptr::load_guarded().
+*/
+template<class ValueType>
+using marked_snapshot_ptr = detail::SnapshotPointer<detail::MarkedSharedPointerTraits<ValueType>>;
+
+/*
+  Same interface as atomic_marked_shared_ptr, loads take a reference with one fetch_add and no hazard pointer.
+*/
+template<class ValueType>
+using split_atomic_marked_shared_ptr = detail::SplitRefCountPointer<detail::MarkedSharedPointerTraits<ValueType>>;
+
 }// namespace lu
 
 #endif
\ No newline at end of file
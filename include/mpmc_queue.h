@@ -0,0 +1,274 @@
+#ifndef __MPMC_QUEUE_H__
+#define __MPMC_QUEUE_H__
+
+#include "hazard_pointer.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t DEFAULT_QUEUE_SEGMENT_SIZE = 1024;
+static constexpr std::size_t DEFAULT_BOUNDED_QUEUE_CAPACITY = 1024;
+
+template<class ValueType>
+struct QueueSlot {
+    static constexpr std::uint8_t EMPTY = 0;
+    static constexpr std::uint8_t FULL = 1;
+    static constexpr std::uint8_t TAKEN = 2;
+
+    std::atomic<std::uint8_t> state{EMPTY};
+    AlignedStorage<ValueType> value;
+};
+
+template<class ValueType, std::size_t SegmentSize>
+struct QueueSegment : public lu::compact_hazard_pointer_obj_base<QueueSegment<ValueType, SegmentSize>> {
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> enqueue_index{};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> dequeue_index{};
+    alignas(CACHE_LINE_SIZE) std::atomic<QueueSegment *> next{};
+    std::array<QueueSlot<ValueType>, SegmentSize> slots{};
+};
+
+template<class ValueType>
+struct BoundedQueueCell {
+    std::atomic<std::size_t> sequence;
+    AlignedStorage<ValueType> value;
+};
+
+}// namespace detail
+
+/*
+  Unbounded queue of segments in the style of FAAArrayQueue (Ramalhete, Correia). Producers and consumers
+  claim slots of the tail and the head segment with a fetch_add instead of competing on one CAS, values
+  live in the slots, and only a whole segment is allocated and retired, once per SegmentSize values.
+  A consumer that gets to a slot before its producer marks it taken, the producer then tries again with
+  the next slot. Both ends move to the next segment with a CAS, like MSQueue.
+*/
+template<class ValueType, std::size_t SegmentSize = detail::DEFAULT_QUEUE_SEGMENT_SIZE>
+class mpmc_queue {
+    using segment_type = detail::QueueSegment<ValueType, SegmentSize>;
+    using slot_type = detail::QueueSlot<ValueType>;
+
+public:
+    using value_type = ValueType;
+
+public:
+    mpmc_queue() {
+        auto segment = new segment_type();
+        head_.store(segment, std::memory_order_relaxed);
+        tail_.store(segment, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue &) = delete;
+
+    mpmc_queue(mpmc_queue &&) = delete;
+
+    ~mpmc_queue() {
+        while (pop()) {
+        }
+        auto head = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next.load(std::memory_order_acquire);
+            delete head;
+            head = next;
+        }
+    }
+
+public:
+    template<class... Args>
+    void push(Args &&...args) {
+        ValueType value(std::forward<Args>(args)...);
+        auto tail_guard = lu::make_hazard_pointer();
+        while (true) {
+            auto tail = tail_guard.protect(tail_);
+            auto index = tail->enqueue_index.fetch_add(1, std::memory_order_relaxed);
+            if (index >= SegmentSize) [[unlikely]] {
+                if (tail != tail_.load()) {
+                    continue;
+                }
+                auto next = tail->next.load();
+                if (!next) {
+                    if (push_segment(tail, value)) {
+                        return;
+                    }
+                } else {
+                    tail_.compare_exchange_strong(tail, next);
+                }
+                continue;
+            }
+            auto &slot = tail->slots[index];
+            slot.value.emplace(std::move(value));
+            auto state = slot_type::EMPTY;
+            if (slot.state.compare_exchange_strong(state, slot_type::FULL, std::memory_order_release,
+                                                   std::memory_order_relaxed)) [[likely]] {
+                return;
+            }
+            value = std::move(*slot.value);
+            slot.value.destroy();
+        }
+    }
+
+    std::optional<ValueType> pop() {
+        auto head_guard = lu::make_hazard_pointer();
+        while (true) {
+            auto head = head_guard.protect(head_);
+            if (head->dequeue_index.load() >= head->enqueue_index.load() && !head->next.load()) {
+                return std::nullopt;
+            }
+            auto index = head->dequeue_index.fetch_add(1, std::memory_order_relaxed);
+            if (index >= SegmentSize) [[unlikely]] {
+                auto next = head->next.load();
+                if (!next) {
+                    return std::nullopt;
+                }
+                auto tail = head;
+                tail_.compare_exchange_strong(tail, next);
+                if (head_.compare_exchange_strong(head, next)) {
+                    head->retire();
+                }
+                continue;
+            }
+            auto &slot = head->slots[index];
+            auto state = slot_type::EMPTY;
+            if (slot.state.compare_exchange_strong(state, slot_type::TAKEN, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+                continue;
+            }
+            std::optional<ValueType> result(std::move(*slot.value));
+            slot.value.destroy();
+            return result;
+        }
+    }
+
+    bool empty() const {
+        auto head_guard = lu::make_hazard_pointer();
+        auto head = head_guard.protect(head_);
+        return head->dequeue_index.load() >= head->enqueue_index.load() && !head->next.load();
+    }
+
+private:
+    /*
+      The first value goes into the new segment before it's published. If another segment won,
+      the value is taken back.
+    */
+    bool push_segment(segment_type *tail, ValueType &value) {
+        auto new_segment = new segment_type();
+        auto &slot = new_segment->slots[0];
+        slot.value.emplace(std::move(value));
+        slot.state.store(slot_type::FULL, std::memory_order_relaxed);
+        new_segment->enqueue_index.store(1, std::memory_order_relaxed);
+
+        segment_type *null{};
+        if (tail->next.compare_exchange_strong(null, new_segment)) {
+            tail_.compare_exchange_strong(tail, new_segment);
+            return true;
+        }
+        value = std::move(*slot.value);
+        slot.value.destroy();
+        delete new_segment;
+        return false;
+    }
+
+private:
+    alignas(detail::CACHE_LINE_SIZE) std::atomic<segment_type *> head_{};
+    alignas(detail::CACHE_LINE_SIZE) std::atomic<segment_type *> tail_{};
+};
+
+/*
+  Bounded ring (Vyukov): every cell carries the position it's ready for, a producer waits for
+  position, a consumer for position + 1. Nothing is allocated or reclaimed after construction.
+  try_push() fails on a full queue and try_pop() on an empty one instead of waiting.
+*/
+template<class ValueType>
+class bounded_mpmc_queue {
+    using cell_type = detail::BoundedQueueCell<ValueType>;
+
+public:
+    using value_type = ValueType;
+
+public:
+    explicit bounded_mpmc_queue(std::size_t capacity = detail::DEFAULT_BOUNDED_QUEUE_CAPACITY)
+        : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+        , cells_(new cell_type[mask_ + 1]) {
+        for (std::size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bounded_mpmc_queue(const bounded_mpmc_queue &) = delete;
+
+    bounded_mpmc_queue(bounded_mpmc_queue &&) = delete;
+
+    ~bounded_mpmc_queue() {
+        while (try_pop()) {
+        }
+    }
+
+public:
+    template<class... Args>
+    bool try_push(Args &&...args) {
+        ValueType value(std::forward<Args>(args)...);
+        auto position = enqueue_position_.load(std::memory_order_relaxed);
+        while (true) {
+            auto &cell = cells_[position & mask_];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0) {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value.emplace(std::move(value));
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<ValueType> try_pop() {
+        auto position = dequeue_position_.load(std::memory_order_relaxed);
+        while (true) {
+            auto &cell = cells_[position & mask_];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (diff == 0) {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    std::optional<ValueType> result(std::move(*cell.value));
+                    cell.value.destroy();
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return result;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+private:
+    const std::size_t mask_;
+    std::unique_ptr<cell_type[]> cells_;
+    alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> enqueue_position_{};
+    alignas(detail::CACHE_LINE_SIZE) std::atomic<std::size_t> dequeue_position_{};
+};
+
+}// namespace lu
+
+#endif
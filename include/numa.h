@@ -0,0 +1,94 @@
+#ifndef __NUMA_H__
+#define __NUMA_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t MAX_NUMA_NODES = 64;
+static constexpr std::size_t NUMA_PAGE_SIZE = 4096;
+
+/*
+  NUMA support without libnuma: the node of a thread comes from getcpu, the count of nodes from sysfs and
+  memory is bound with mbind. Everything falls back to a single node 0 where they aren't available.
+*/
+class Numa {
+public:
+    /*
+      Node the calling thread is running on right now.
+    */
+    static std::size_t get_current_node() noexcept {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu{};
+        unsigned node{};
+        if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+            return std::min<std::size_t>(node, get_num_of_nodes() - 1);
+        }
+#endif
+        return 0;
+    }
+
+    /*
+      Node the calling thread first asked for, a thread keeps its node even if it migrates later.
+    */
+    static std::size_t get_home_node() noexcept {
+        static thread_local std::size_t node = get_current_node();
+        return node;
+    }
+
+    static std::size_t get_num_of_nodes() noexcept {
+        static const std::size_t num_of_nodes = read_num_of_nodes();
+        return num_of_nodes;
+    }
+
+    /*
+      Asks for the pages of the range to be placed on the node before they are touched. It's a hint,
+      failures are ignored.
+    */
+    static void bind(void *ptr, std::size_t size, std::size_t node) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+        static constexpr int MPOL_PREFERRED = 1;
+        static constexpr unsigned MPOL_MF_MOVE = 1u << 1;
+        unsigned long mask = 1ul << node;
+        ::syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, &mask, MAX_NUMA_NODES + 1, MPOL_MF_MOVE);
+#else
+        (void) ptr;
+        (void) size;
+        (void) node;
+#endif
+    }
+
+private:
+    /*
+      sysfs lists the possible nodes as ranges, like "0" or "0-1", the last number is the highest node.
+    */
+    static std::size_t read_num_of_nodes() noexcept {
+#if defined(__linux__)
+        std::ifstream file("/sys/devices/system/node/possible");
+        std::string ranges;
+        if (file >> ranges) {
+            auto last = ranges.find_last_of(",-");
+            auto highest = std::strtoul(ranges.c_str() + (last == std::string::npos ? 0 : last + 1), nullptr, 10);
+            return std::clamp<std::size_t>(highest + 1, 1, MAX_NUMA_NODES);
+        }
+#endif
+        return 1;
+    }
+};
+
+}// namespace detail
+}// namespace lu
+
+#endif
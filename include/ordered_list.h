@@ -1,19 +1,27 @@
 #ifndef __ORDERED_LIST_H__
 #define __ORDERED_LIST_H__
 
-#include <back_off.h>
-#include <hazard_pointer.h>
-#include <marked_ptr.h>
+#include "back_off.h"
+#include "hazard_pointer.h"
+#include "key_select.h"
+#include "marked_ptr.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 
 namespace lu {
 namespace detail {
 
 template<class ValueType>
-struct OrderedListNode : public lu::hazard_pointer_obj_base<OrderedListNode<ValueType>> {
+struct OrderedListNode : public lu::compact_hazard_pointer_obj_base<OrderedListNode<ValueType>> {
 public:
     template<class... Args>
     explicit OrderedListNode(Args &&...args)
@@ -26,6 +34,8 @@ public:
 
 template<class ValueType, class KeyCompare, class KeySelect, class Backoff>
 class OrderedList : private lu::detail::EmptyBaseHolder<KeyCompare>, private lu::detail::EmptyBaseHolder<KeySelect> {
+    template<class, class, class, class, class>
+    friend class SplitOrderedList;
 
     using KeyCompareHolder = lu::detail::EmptyBaseHolder<KeyCompare>;
     using KeySelectHolder = lu::detail::EmptyBaseHolder<KeySelect>;
@@ -41,9 +51,23 @@ class OrderedList : private lu::detail::EmptyBaseHolder<KeyCompare>, private lu:
         node_marked_ptr next;
         std::atomic<node_marked_ptr> *prev_pointer;
 
-        lu::hazard_pointer cur_guard{lu::make_hazard_pointer()};
-        lu::hazard_pointer next_guard{lu::make_hazard_pointer()};
-        lu::hazard_pointer prev_guard{lu::make_hazard_pointer()};
+        /*
+          Ordered as the traversal moves: a step forward rotates the guards, so the node behind
+          stays protected by the guard it was protected with as cur.
+        */
+        static constexpr std::size_t PREV = 0;
+        static constexpr std::size_t CUR = 1;
+        static constexpr std::size_t NEXT = 2;
+
+        lu::hazard_pointer_array<3> guards{lu::make_hazard_pointer_array<3>()};
+
+        lu::hazard_pointer &cur_guard() noexcept {
+            return guards[CUR];
+        }
+
+        lu::hazard_pointer &next_guard() noexcept {
+            return guards[NEXT];
+        }
     };
 
     template<class Types, bool IsConst>
@@ -162,7 +186,7 @@ class OrderedList : private lu::detail::EmptyBaseHolder<KeyCompare>, private lu:
             if (next.get_bit()) {
                 position new_pos;
                 list_->find(list_->select_key(current_->value), new_pos);
-                guard_ = std::move(new_pos.cur_guard);
+                guard_ = std::move(new_pos.cur_guard());
                 current_ = new_pos.cur;
             } else {
                 guard_ = std::move(next_guard);
@@ -220,15 +244,22 @@ private:
         }
     }
 
+    /*
+      The search may start at the next pointer of a protected node, it falls back to restart once that
+      node is removed.
+    */
     template<class _KeyCompare, class _KeySelect>
-    static bool find(std::atomic<node_marked_ptr> *head, const key_type &key, position &pos, _KeyCompare &&comp,
-                     _KeySelect &&key_select) {
+    static bool find(std::atomic<node_marked_ptr> *head, std::atomic<node_marked_ptr> *restart, const key_type &key,
+                     position &pos, _KeyCompare &&comp, _KeySelect &&key_select) {
         Backoff back_off;
 
     try_again:
+        if (head != restart && head->load().get_bit()) [[unlikely]] {
+            head = restart;
+        }
         pos.prev_pointer = head;
 
-        pos.cur = pos.cur_guard.protect(*head, [](node_marked_ptr ptr) { return ptr.get(); });
+        pos.cur = pos.cur_guard().protect(*head, [](node_marked_ptr ptr) { return ptr.get(); });
 
         while (true) {
             if (!pos.cur) {
@@ -237,7 +268,7 @@ private:
                 return false;
             }
 
-            pos.next = pos.next_guard.protect(pos.cur->next, [](node_marked_ptr ptr) { return ptr.get(); });
+            pos.next = pos.next_guard().protect(pos.cur->next, [](node_marked_ptr ptr) { return ptr.get(); });
 
             if (pos.prev_pointer->load().all() != pos.cur) {
                 back_off();
@@ -252,18 +283,153 @@ private:
                     back_off();
                     goto try_again;
                 }
+                pos.guards.swap(position::CUR, position::NEXT);
             } else {
                 if (!comp(key_select(pos.cur->value), key)) {
                     return !comp(key, key_select(pos.cur->value));
                 }
                 pos.prev_pointer = &(pos.cur->next);
-                pos.prev_guard.reset_protection(pos.cur);
+                pos.guards.rotate();
             }
-            pos.cur_guard.reset_protection(pos.next.get());
             pos.cur = pos.next;
         }
     }
 
+    /*
+      Moves pos to the first node from pos.cur on that is still linked, removed nodes are unlinked
+      on the way as find() does. Returns false if the node pos.prev_pointer points into was removed.
+    */
+    static bool walk(position &pos) {
+        while (pos.cur) {
+            pos.next = pos.next_guard().protect(pos.cur->next, [](node_marked_ptr ptr) { return ptr.get(); });
+            if (pos.prev_pointer->load().all() != pos.cur) {
+                node_marked_ptr cur
+                        = pos.cur_guard().protect(*pos.prev_pointer, [](node_marked_ptr ptr) { return ptr.get(); });
+                if (cur.get_bit()) {
+                    return false;
+                }
+                pos.cur = cur;
+                continue;
+            }
+            if (!pos.next.get_bit()) {
+                return true;
+            }
+            node_marked_ptr not_marked_cur(pos.cur, 0);
+            if (pos.prev_pointer->compare_exchange_weak(not_marked_cur, node_marked_ptr(pos.next, 0))) {
+                pos.cur->retire();
+                pos.guards.swap(position::CUR, position::NEXT);
+                pos.cur = pos.next;
+            }
+        }
+        return true;
+    }
+
+    /*
+      One pass over the list on a single position. The node visited last stays protected, so a removed
+      node is skipped from there instead of from the head, the key is only looked up again when the
+      node visited last is removed too. The key may have been inserted again by then, so a node with the same key
+      is stepped over. Keys come in ascending order, each one at most once.
+    */
+    class GuardedRange {
+        friend class OrderedList;
+
+        using range_reference = std::conditional_t<is_key_value, reference, const_reference>;
+        using range_pointer = std::conditional_t<is_key_value, pointer, const_pointer>;
+
+    public:
+        class iterator {
+            friend class GuardedRange;
+
+        public:
+            using value_type = OrderedList::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = range_pointer;
+            using reference = range_reference;
+            using iterator_category = std::input_iterator_tag;
+
+        public:
+            iterator() = default;
+
+            reference operator*() const noexcept {
+                return range_->pos_.cur->value;
+            }
+
+            pointer operator->() const noexcept {
+                return &range_->pos_.cur->value;
+            }
+
+            iterator &operator++() {
+                range_->increment();
+                return *this;
+            }
+
+            void operator++(int) {
+                range_->increment();
+            }
+
+            friend bool operator==(const iterator &it, std::default_sentinel_t) noexcept {
+                return it.is_end();
+            }
+
+        private:
+            explicit iterator(GuardedRange *range) noexcept
+                : range_(range) {}
+
+            bool is_end() const noexcept {
+                return !range_->pos_.cur;
+            }
+
+        private:
+            GuardedRange *range_{};
+        };
+
+    private:
+        explicit GuardedRange(const OrderedList *list)
+            : list_(list) {
+            pos_.prev_pointer = list_->get_head();
+            pos_.cur = pos_.cur_guard().protect(*pos_.prev_pointer, [](node_marked_ptr ptr) { return ptr.get(); });
+            walk(pos_);
+        }
+
+    public:
+        GuardedRange(const GuardedRange &) = delete;
+
+        GuardedRange(GuardedRange &&) = delete;
+
+        iterator begin() noexcept {
+            return iterator(this);
+        }
+
+        std::default_sentinel_t end() const noexcept {
+            return {};
+        }
+
+    private:
+        void increment() {
+            auto last = pos_.cur;
+            pos_.prev_pointer = &last->next;
+            pos_.guards.rotate();
+            pos_.cur = pos_.next;
+            while (!walk(pos_)) [[unlikely]] {
+                const key_type key(list_->select_key(last->value));
+                if (!list_->find(key, pos_)) {
+                    return;
+                }
+                last = pos_.cur;
+                pos_.prev_pointer = &last->next;
+                pos_.guards.rotate();
+                pos_.cur = pos_.next;
+            }
+        }
+
+    private:
+        const OrderedList *list_;
+        position pos_;
+    };
+
+public:
+    using guarded_range_type = GuardedRange;
+
 public:
     explicit OrderedList(const compare &compare = {}, const key_select &key_select = {})
         : KeyCompareHolder(compare)
@@ -283,19 +449,35 @@ private:
         return key_select(value);
     }
 
-    bool find(const key_type &key, position &pos) const {
+    /*
+      The operations below start at the given link, the head of the list or the next pointer of
+      a node that is never removed, as the buckets of SplitOrderedList do.
+    */
+    std::atomic<node_marked_ptr> *get_head() const noexcept {
+        return const_cast<std::atomic<node_marked_ptr> *>(&head_);
+    }
+
+    bool find(std::atomic<node_marked_ptr> *start, std::atomic<node_marked_ptr> *head, const key_type &key,
+              position &pos) const {
         auto comp = KeyCompareHolder::get();
         auto key_select = KeySelectHolder::get();
 
-        return find(const_cast<std::atomic<node_marked_ptr> *>(&head_), key, pos, comp, key_select);
+        return find(start, head, key, pos, comp, key_select);
     }
 
-    bool insert_node(node_ptr new_node) {
+    bool find(std::atomic<node_marked_ptr> *head, const key_type &key, position &pos) const {
+        return find(head, head, key, pos);
+    }
+
+    bool find(const key_type &key, position &pos) const {
+        return find(get_head(), key, pos);
+    }
+
+    bool insert_node(std::atomic<node_marked_ptr> *head, node_ptr new_node, position &pos) {
         auto key_select = KeySelectHolder::get();
         Backoff back_off;
-        position pos;
         while (true) {
-            if (find(key_select(new_node->value), pos)) {
+            if (find(head, key_select(new_node->value), pos)) {
                 return false;
             }
             if (link(pos, new_node)) {
@@ -305,6 +487,44 @@ private:
         }
     }
 
+    bool insert_node(node_ptr new_node) {
+        position pos;
+        return insert_node(get_head(), new_node, pos);
+    }
+
+    bool erase(std::atomic<node_marked_ptr> *head, const key_type &value) {
+        Backoff back_off;
+        position pos;
+        while (find(head, value, pos)) {
+            if (unlink(pos)) {
+                return true;
+            }
+            back_off();
+        }
+        return false;
+    }
+
+    guarded_ptr extract(std::atomic<node_marked_ptr> *head, const key_type &value) {
+        Backoff back_off;
+        position pos;
+        while (find(head, value, pos)) {
+            if (unlink(pos)) {
+                return guarded_ptr(std::move(pos.cur_guard()), &pos.cur->value);
+            }
+            back_off();
+        }
+        return guarded_ptr();
+    }
+
+    guarded_ptr find(std::atomic<node_marked_ptr> *head, const key_type &value) const {
+        position pos;
+        if (find(head, value, pos)) {
+            return guarded_ptr(std::move(pos.cur_guard()), &pos.cur->value);
+        } else {
+            return guarded_ptr();
+        }
+    }
+
 public:
     bool insert(const value_type &value) {
         return emplace(value);
@@ -324,28 +544,54 @@ public:
         return true;
     }
 
-    bool erase(const key_type &value) {
+    /*
+      The values are sorted and linked in one pass, each search starts at the node linked last instead
+      of the head. Values whose key is already present, or repeated in the range, are dropped as by
+      insert(), returns the number of inserted values.
+    */
+    template<class Iterator>
+    std::size_t insert_range(Iterator first, Iterator last) {
+        auto comp = KeyCompareHolder::get();
+        auto key_select = KeySelectHolder::get();
+
+        std::vector<std::unique_ptr<node_type>> nodes;
+        for (; first != last; ++first) {
+            nodes.push_back(std::make_unique<node_type>(*first));
+        }
+        std::stable_sort(nodes.begin(), nodes.end(), [&comp, &key_select](const auto &left, const auto &right) {
+            return comp(key_select(left->value), key_select(right->value));
+        });
+        auto equal = [&comp, &key_select](const auto &left, const auto &right) {
+            return !comp(key_select(left->value), key_select(right->value));
+        };
+        nodes.erase(std::unique(nodes.begin(), nodes.end(), equal), nodes.end());
+
         Backoff back_off;
         position pos;
-        while (find(value, pos)) {
-            if (unlink(pos)) {
-                return true;
+        auto start_guards = lu::make_hazard_pointer_array<2>();
+        auto start = get_head();
+        std::size_t num_of_inserted = 0;
+        for (auto &node: nodes) {
+            start_guards[1].reset_protection(node.get());
+            while (!find(start, get_head(), key_select(node->value), pos)) {
+                if (link(pos, node.get())) {
+                    start = &node.release()->next;
+                    start_guards.swap(0, 1);
+                    ++num_of_inserted;
+                    break;
+                }
+                back_off();
             }
-            back_off();
         }
-        return false;
+        return num_of_inserted;
+    }
+
+    bool erase(const key_type &value) {
+        return erase(get_head(), value);
     }
 
     guarded_ptr extract(const key_type &value) {
-        Backoff back_off;
-        position pos;
-        while (find(value, pos)) {
-            if (unlink(pos)) {
-                return guarded_ptr(std::move(pos.cur_guard), &pos.cur->value);
-            }
-            back_off();
-        }
-        return guarded_ptr();
+        return extract(get_head(), value);
     }
 
     void clear() {
@@ -364,19 +610,14 @@ public:
     }
 
     guarded_ptr find(const key_type &value) const {
-        position pos;
-        if (find(value, pos)) {
-            return guarded_ptr(std::move(pos.cur_guard), &pos.cur->value);
-        } else {
-            return guarded_ptr();
-        }
+        return find(get_head(), value);
     }
 
     guarded_ptr find_no_less(const key_type &value) const {
         position pos;
         find(value, pos);
         if (pos.cur) {
-            return guarded_ptr(std::move(pos.cur_guard), &pos.cur->value);
+            return guarded_ptr(std::move(pos.cur_guard()), &pos.cur->value);
         } else {
             return guarded_ptr();
         }
@@ -411,6 +652,10 @@ public:
         return const_iterator();
     }
 
+    guarded_range_type guarded_range() const {
+        return guarded_range_type(this);
+    }
+
     const_iterator begin() const {
         return cbegin();
     }
@@ -423,25 +668,6 @@ private:
     std::atomic<node_marked_ptr> head_{};
 };
 
-template<class KeyType, class ValueType>
-struct MapKeySelect {
-    using type = KeyType;
-
-    const KeyType &operator()(const std::pair<KeyType, ValueType> &value) {
-        return value.first;
-    }
-};
-
-template<class KeyType>
-struct SetKeySelect {
-    using type = KeyType;
-
-    template<class T, class = std::enable_if_t<std::is_same_v<std::decay_t<T>, KeyType>>>
-    T &&operator()(T &&value) {
-        return std::forward<T>(value);
-    }
-};
-
 struct OrderedListDefaults {
     using compare = void;
     using backoff = void;
@@ -0,0 +1,257 @@
+#ifndef __POOL_ALLOCATOR_H__
+#define __POOL_ALLOCATOR_H__
+
+#include "thread_local_list.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t POOL_SLAB_SIZE = 64 * 1024;
+static constexpr std::size_t POOL_MAX_BLOCK_SIZE = POOL_SLAB_SIZE / 16;
+static constexpr std::size_t POOL_REMOTE_BATCH = 32;
+
+struct PoolBlock {
+    PoolBlock *next;
+};
+
+class PoolCache;
+
+/*
+  Slabs are aligned to their size, so the cache owning a block is found from the block's address.
+*/
+struct alignas(CACHE_LINE_SIZE) PoolSlab {
+    PoolCache *owner;
+    PoolSlab *next;
+};
+
+inline PoolSlab *get_pool_slab(void *block) noexcept {
+    return reinterpret_cast<PoolSlab *>(reinterpret_cast<std::uintptr_t>(block) & ~(POOL_SLAB_SIZE - 1));
+}
+
+/*
+  Blocks of one size class owned by a thread. The owner allocates and frees through its free list without
+  atomics. Blocks freed by other threads (the scans reclaiming retired objects) are collected in a batch
+  per owner and pushed to the owner's remote list with one CAS; the owner takes the whole list when its
+  free list runs dry. Memory never goes back to the global allocator, a cache outlives its thread and is
+  adopted with everything it holds by the next thread.
+*/
+class PoolCache : public lu::thread_local_list_base_hook {
+public:
+    PoolCache(std::size_t block_size, std::size_t block_align) noexcept
+        : block_size_(block_size)
+        , block_align_(block_align) {}
+
+    PoolCache(const PoolCache &) = delete;
+
+    PoolCache(PoolCache &&) = delete;
+
+    ~PoolCache() {
+        while (slabs_) {
+            auto next = slabs_->next;
+            ::operator delete(slabs_, std::align_val_t(POOL_SLAB_SIZE));
+            slabs_ = next;
+        }
+    }
+
+    void *allocate() {
+        if (!free_) [[unlikely]] {
+            free_ = remote_.exchange(nullptr, std::memory_order_acquire);
+            if (!free_) {
+                refill();
+            }
+        }
+        auto block = free_;
+        free_ = block->next;
+        return block;
+    }
+
+    void deallocate(void *ptr) noexcept {
+        auto block = static_cast<PoolBlock *>(ptr);
+        auto owner = get_pool_slab(ptr)->owner;
+        if (owner == this) [[likely]] {
+            block->next = free_;
+            free_ = block;
+            return;
+        }
+        if (owner != batch_owner_) {
+            flush_batch();
+            batch_owner_ = owner;
+        }
+        block->next = batch_head_;
+        if (!batch_head_) {
+            batch_tail_ = block;
+        }
+        batch_head_ = block;
+        if (++batch_size_ == POOL_REMOTE_BATCH) {
+            flush_batch();
+        }
+    }
+
+    /*
+      Called when the thread detaches, so a batch isn't held by a cache without a thread.
+    */
+    void flush_batch() noexcept {
+        if (!batch_head_) {
+            return;
+        }
+        auto &remote = batch_owner_->remote_;
+        auto head = remote.load(std::memory_order_relaxed);
+        do {
+            batch_tail_->next = head;
+        } while (!remote.compare_exchange_weak(head, batch_head_, std::memory_order_release,
+                                               std::memory_order_relaxed));
+        batch_head_ = {};
+        batch_tail_ = {};
+        batch_size_ = 0;
+    }
+
+private:
+    void refill() {
+        auto slab = static_cast<PoolSlab *>(::operator new(POOL_SLAB_SIZE, std::align_val_t(POOL_SLAB_SIZE)));
+        slab->owner = this;
+        slab->next = slabs_;
+        slabs_ = slab;
+
+        auto data = reinterpret_cast<std::uint8_t *>(slab);
+        auto first = align_up(sizeof(PoolSlab), block_align_);
+        auto num_of_blocks = (POOL_SLAB_SIZE - first) / block_size_;
+        for (std::size_t i = num_of_blocks; i > 0; --i) {
+            auto block = reinterpret_cast<PoolBlock *>(data + first + (i - 1) * block_size_);
+            block->next = free_;
+            free_ = block;
+        }
+    }
+
+private:
+    const std::size_t block_size_;
+    const std::size_t block_align_;
+    PoolBlock *free_{};
+    PoolSlab *slabs_{};
+
+    PoolCache *batch_owner_{};
+    PoolBlock *batch_head_{};
+    PoolBlock *batch_tail_{};
+    std::size_t batch_size_{};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<PoolBlock *> remote_{};
+};
+
+/*
+  The caches of a size class are never destroyed: blocks can still be freed by static destructors
+  (a domain reclaiming what was left retired) running after it would have been.
+*/
+template<std::size_t BlockSize, std::size_t BlockAlign>
+PoolCache &get_pool_cache() {
+    struct Detacher {
+        void operator()(PoolCache *cache) const {
+            cache->flush_batch();
+        }
+    };
+
+    struct Creator {
+        PoolCache *operator()() const {
+            return new PoolCache(BlockSize, BlockAlign);
+        }
+    };
+
+    static auto list = new lu::thread_local_list<PoolCache>(Detacher{}, Creator{});
+    return list->get_thread_local();
+}
+
+template<class ValueType>
+struct PoolSizeClass {
+    static constexpr std::size_t block_align = std::max(alignof(ValueType), alignof(PoolBlock));
+    static constexpr std::size_t block_size = align_up(std::max(sizeof(ValueType), sizeof(PoolBlock)), block_align);
+
+    static constexpr bool is_pooled = block_align <= CACHE_LINE_SIZE && block_size <= POOL_MAX_BLOCK_SIZE;
+};
+
+}// namespace detail
+
+/*
+  Allocator over per-thread slab pools of type-stable memory. It plugs into alloc_shared() and
+  the allocators of the control blocks; single objects come from the pool, arrays and types
+  that don't fit a slab go to std::allocator. All instances are interchangeable.
+*/
+template<class ValueType>
+class pool_allocator {
+    using SizeClass = detail::PoolSizeClass<ValueType>;
+
+public:
+    using value_type = ValueType;
+
+public:
+    pool_allocator() noexcept = default;
+
+    template<class Other>
+    pool_allocator(const pool_allocator<Other> &) noexcept {}
+
+    [[nodiscard]] value_type *allocate(std::size_t n) {
+        if constexpr (SizeClass::is_pooled) {
+            if (n == 1) [[likely]] {
+                auto &cache = detail::get_pool_cache<SizeClass::block_size, SizeClass::block_align>();
+                return static_cast<value_type *>(cache.allocate());
+            }
+        }
+        return std::allocator<value_type>().allocate(n);
+    }
+
+    void deallocate(value_type *ptr, std::size_t n) noexcept {
+        if constexpr (SizeClass::is_pooled) {
+            if (n == 1) [[likely]] {
+                auto &cache = detail::get_pool_cache<SizeClass::block_size, SizeClass::block_align>();
+                cache.deallocate(ptr);
+                return;
+            }
+        }
+        std::allocator<value_type>().deallocate(ptr, n);
+    }
+
+    template<class Other>
+    friend bool operator==(const pool_allocator &, const pool_allocator<Other> &) noexcept {
+        return true;
+    }
+};
+
+/*
+  Deleter for objects created by pool_new(), e.g. as the Deleter of hazard_pointer_obj_base. It must name
+  the type the object was created with, the size class depends on it.
+*/
+template<class ValueType>
+struct pool_deleter {
+    pool_deleter() noexcept = default;
+
+    void operator()(ValueType *value) const {
+        std::destroy_at(value);
+        pool_allocator<ValueType>().deallocate(value, 1);
+    }
+};
+
+template<class ValueType, class... Args>
+ValueType *pool_new(Args &&...args) {
+    using Allocator = pool_allocator<ValueType>;
+    using AllocatorTraits = std::allocator_traits<Allocator>;
+
+    Allocator allocator;
+    detail::AllocateGuard<Allocator> allocate_guard(allocator);
+
+    auto result = allocate_guard.allocate();
+    AllocatorTraits::construct(allocator, result, std::forward<Args>(args)...);
+
+    return allocate_guard.release();
+}
+
+}// namespace lu
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef __RECLAMATION_STATS_H__
+#define __RECLAMATION_STATS_H__
+
+#include "fixed_size_function.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+
+namespace lu {
+
+/*
+  Counters of a domain aggregated over all its thread data. They are only collected when
+  the library is built with LU_HAZARD_POINTERS_STATS defined, otherwise everything stays zero.
+  The exception is num_of_pending, counted by a domain with a retire budget in any build.
+*/
+struct reclamation_stats {
+    std::size_t num_of_scans{};
+    std::chrono::nanoseconds scan_duration{};
+    std::chrono::nanoseconds max_scan_duration{};
+    std::size_t num_of_inspected_records{};
+    std::size_t num_of_remote_records{};
+    std::size_t num_of_scanned_retires{};
+    std::size_t num_of_kept_alive{};
+    std::size_t peak_backlog{};
+    std::size_t num_of_merged_orphans{};
+    std::size_t num_of_failed_acquires{};
+    std::size_t num_of_over_budget{};
+    std::size_t num_of_pending{};
+
+    /*
+      Fraction of the retired objects looked at by scans that had to be kept because they were protected.
+    */
+    double kept_alive_ratio() const noexcept {
+        if (!num_of_scanned_retires) {
+            return 0;
+        }
+        return static_cast<double>(num_of_kept_alive) / static_cast<double>(num_of_scanned_retires);
+    }
+};
+
+/*
+  What a single scan did, passed to the stats hook right after the scan.
+*/
+struct scan_sample {
+    std::chrono::nanoseconds duration{};
+    std::size_t num_of_inspected_records{};
+    std::size_t num_of_scanned_retires{};
+    std::size_t num_of_reclaimed{};
+};
+
+using stats_hook = lu::fixed_size_function<void(const scan_sample &), 64>;
+
+namespace detail {
+
+#if defined(LU_HAZARD_POINTERS_STATS)
+static constexpr bool STATS_ENABLED = true;
+#else
+static constexpr bool STATS_ENABLED = false;
+#endif
+
+template<bool Enabled = STATS_ENABLED>
+class ReclamationCounters;
+
+/*
+  Every counter is written by the owner of the thread data only, so a relaxed load and store is enough
+  and no read-modify-write is needed. Readers of a snapshot may see slightly stale values.
+*/
+template<>
+class ReclamationCounters<true> {
+    using clock = std::chrono::steady_clock;
+
+public:
+    using time_point = typename clock::time_point;
+
+public:
+    time_point start_scan(std::size_t backlog) noexcept {
+        update_peak_backlog(backlog);
+        return clock::now();
+    }
+
+    scan_sample finish_scan(time_point start, std::size_t num_of_inspected_records,
+                            std::size_t num_of_scanned_retires, std::size_t num_of_kept_alive) noexcept {
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+        add(num_of_scans_, 1);
+        add(scan_duration_, static_cast<std::size_t>(duration.count()));
+        max(max_scan_duration_, static_cast<std::size_t>(duration.count()));
+        add(num_of_inspected_records_, num_of_inspected_records);
+        add(num_of_scanned_retires_, num_of_scanned_retires);
+        add(num_of_kept_alive_, num_of_kept_alive);
+        return {duration, num_of_inspected_records, num_of_scanned_retires,
+                num_of_scanned_retires - num_of_kept_alive};
+    }
+
+    void update_peak_backlog(std::size_t backlog) noexcept {
+        max(peak_backlog_, backlog);
+    }
+
+    void add_merged_orphans(std::size_t count) noexcept {
+        add(num_of_merged_orphans_, count);
+    }
+
+    /*
+      Records of threads of another NUMA node, read by a scan.
+    */
+    void add_remote_records(std::size_t count) noexcept {
+        add(num_of_remote_records_, count);
+    }
+
+    void add_failed_acquire() noexcept {
+        add(num_of_failed_acquires_, 1);
+    }
+
+    void add_over_budget() noexcept {
+        add(num_of_over_budget_, 1);
+    }
+
+    void collect(reclamation_stats &stats) const noexcept {
+        stats.num_of_scans += load(num_of_scans_);
+        stats.scan_duration += std::chrono::nanoseconds(load(scan_duration_));
+        stats.max_scan_duration
+                = std::max(stats.max_scan_duration, std::chrono::nanoseconds(load(max_scan_duration_)));
+        stats.num_of_inspected_records += load(num_of_inspected_records_);
+        stats.num_of_remote_records += load(num_of_remote_records_);
+        stats.num_of_scanned_retires += load(num_of_scanned_retires_);
+        stats.num_of_kept_alive += load(num_of_kept_alive_);
+        stats.peak_backlog = std::max(stats.peak_backlog, load(peak_backlog_));
+        stats.num_of_merged_orphans += load(num_of_merged_orphans_);
+        stats.num_of_failed_acquires += load(num_of_failed_acquires_);
+        stats.num_of_over_budget += load(num_of_over_budget_);
+    }
+
+private:
+    using counter = std::atomic<std::size_t>;
+
+    static std::size_t load(const counter &value) noexcept {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    static void add(counter &value, std::size_t count) noexcept {
+        value.store(load(value) + count, std::memory_order_relaxed);
+    }
+
+    static void max(counter &value, std::size_t other) noexcept {
+        if (load(value) < other) {
+            value.store(other, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    counter num_of_scans_{};
+    counter scan_duration_{};
+    counter max_scan_duration_{};
+    counter num_of_inspected_records_{};
+    counter num_of_remote_records_{};
+    counter num_of_scanned_retires_{};
+    counter num_of_kept_alive_{};
+    counter peak_backlog_{};
+    counter num_of_merged_orphans_{};
+    counter num_of_failed_acquires_{};
+    counter num_of_over_budget_{};
+};
+
+template<>
+class ReclamationCounters<false> {
+public:
+    struct time_point {};
+
+public:
+    time_point start_scan(std::size_t) noexcept {
+        return {};
+    }
+
+    scan_sample finish_scan(time_point, std::size_t, std::size_t, std::size_t) noexcept {
+        return {};
+    }
+
+    void update_peak_backlog(std::size_t) noexcept {}
+
+    void add_merged_orphans(std::size_t) noexcept {}
+
+    void add_remote_records(std::size_t) noexcept {}
+
+    void add_failed_acquire() noexcept {}
+
+    void add_over_budget() noexcept {}
+
+    void collect(reclamation_stats &) const noexcept {}
+};
+
+}// namespace detail
+}// namespace lu
+
+#endif
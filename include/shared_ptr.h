@@ -3,17 +3,20 @@
 
 #include "atomic_shared_pointer.h"
 #include "hazard_pointer.h"
-#include "intrusive/forward_list.h"
-#include "intrusive/options.h"
 #include "intrusive/utils.h"
+#include "split_ref_count_pointer.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 
 namespace lu {
@@ -22,25 +25,193 @@ namespace detail {
 struct ControlBlockDeleter {
     template<class ControlBlock>
     void operator()(ControlBlock *ptr) {
-        ptr->DeleteControlBlock();
+        ptr->DestroyControlBlock();
     }
 };
 
-class ControlBlock : public lu::forward_list_base_hook<lu::is_auto_unlink<false>>,
-                     public lu::hazard_pointer_obj_base<ControlBlock, ControlBlockDeleter> {
+class ControlBlock;
+
+/*
+  Per thread record the biased control blocks of a thread point to. Other threads queue a control block here
+  when its shared count goes negative, the owner merges its biased count at the next drain. After the thread
+  has exited the queue is closed and a queueing thread merges by itself. The record lives until the last
+  control block biased to it is destroyed.
+*/
+class BiasedOwner {
+    struct ExitGuard {
+        ~ExitGuard() {
+            if (owner) {
+                get_current() = nullptr;
+                owner->Exit();
+            }
+        }
+
+        BiasedOwner *owner{};
+    };
+
+public:
+    static BiasedOwner *&get_current() noexcept {
+        static thread_local BiasedOwner *current{};
+        return current;
+    }
+
+    static BiasedOwner *Acquire() {
+        auto &current = get_current();
+        if (!current) [[unlikely]] {
+            static thread_local ExitGuard guard{};
+            current = new BiasedOwner();
+            guard.owner = current;
+        } else {
+            current->Drain();
+        }
+        current->ref_count_.fetch_add(1, std::memory_order_relaxed);
+        return current;
+    }
+
+    void Release() noexcept {
+        if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    inline void Push(ControlBlock *control_block);
+
+    inline void Drain();
+
+private:
+    BiasedOwner() = default;
+
+    inline void Exit();
+
+    static ControlBlock *get_closed() noexcept {
+        return reinterpret_cast<ControlBlock *>(alignof(ControlBlock *));
+    }
+
+private:
+    std::atomic<ControlBlock *> queue_{};
+    std::atomic<std::size_t> ref_count_{1};
+};
+
+static constexpr std::size_t DEFERRED_DESTRUCTION_BATCH = 64;
+static constexpr std::size_t DEFAULT_DEFERRED_DESTRUCTION_LIMIT = 256;
+
+/*
+  Per thread queue of dead control blocks, see enable_deferred_destruction(). A control block is
+  queued instead of retired, a full batch is handed to the domain with one retire_batch() and no more
+  than the limit is handed over per call. Control blocks released by a scan (values owning other
+  values) are queued as well and wait for a later call, so destroying a large graph doesn't turn
+  into one long scan.
+*/
+class DeferredDestruction {
+    struct ExitGuard {
+        ~ExitGuard() {
+            if (queue) {
+                get_current() = nullptr;
+                queue->FlushAll();
+                delete queue;
+            }
+        }
+
+        DeferredDestruction *queue{};
+    };
+
+public:
+    static DeferredDestruction *&get_current() noexcept {
+        static thread_local DeferredDestruction *current{};
+        return current;
+    }
+
+    /*
+      The thread data of the domain is attached before the guard is created, so it outlives the queue
+      at thread exit.
+    */
+    static void Enable(std::size_t max_per_call) {
+        static_cast<void>(lu::make_hazard_pointer());
+        static thread_local ExitGuard guard{};
+        if (!guard.queue) {
+            guard.queue = new DeferredDestruction();
+        }
+        guard.queue->max_per_call_ = std::max(max_per_call, DEFERRED_DESTRUCTION_BATCH);
+        get_current() = guard.queue;
+    }
+
+    static void Disable() {
+        if (auto queue = std::exchange(get_current(), nullptr)) {
+            queue->FlushAll();
+        }
+    }
+
+    inline void Push(ControlBlock *control_block);
+
+    inline std::size_t Flush(std::size_t max_count);
+
+    void FlushAll() {
+        while (Flush(std::numeric_limits<std::size_t>::max())) {
+        }
+    }
+
+    std::size_t size() const noexcept {
+        return pending_.size();
+    }
+
+private:
+    DeferredDestruction() = default;
+
+private:
+    std::vector<ControlBlock *> pending_;
+    std::vector<ControlBlock *> batch_;
+    std::size_t max_per_call_{DEFAULT_DEFERRED_DESTRUCTION_LIMIT};
+    bool is_flushing_{};
+};
+
+/*
+  Biased state of a control block, only written by the owner thread until the count is merged.
+*/
+struct BiasedState {
+    BiasedOwner *owner{};
+    std::atomic<std::int64_t> count{};
+    ControlBlock *next{};
+};
+
+/*
+  The last strong reference retires the control block and the value is destroyed by the hazard domain,
+  so a reader that only protects the control block can still look at the value. The weak reference
+  of the strong ones is dropped after that, when no reader can reach the control block any more,
+  so the last weak reference frees it right away. Values released by a destroyed value are retired
+  by the same scan, which also keeps long chains from recursing.
+
+  The strong count is kept in units of REF_ONE with two flags in the low bits. A biased control block
+  (Choi et al.) starts with the count of its creator kept in BiasedState: the owner thread updates it
+  with plain loads and stores, all other threads use the shared count, which may go negative. When the
+  biased count drops to zero the owner sets MERGED; the control block is dead once the count is zero and
+  MERGED is set while it's not QUEUED. Unbiased control blocks are merged from the start.
+*/
+class ControlBlock : public lu::compact_hazard_pointer_obj_base<ControlBlock, ControlBlockDeleter> {
 public:
     friend struct ControlBlockDeleter;
 
+    friend class BiasedOwner;
+
+    friend class DeferredDestruction;
+
+    static constexpr std::int64_t MERGED = 1;
+    static constexpr std::int64_t QUEUED = 2;
+    static constexpr std::int64_t REF_ONE = 4;
+
 public:
     ControlBlock() = default;
 
     virtual ~ControlBlock() = default;
 
 public:
+    /*
+      A biased control block that isn't merged yet is alive as long as the owner has references,
+      so the increment succeeds even if the other threads have just dropped theirs.
+    */
     inline bool IncRefIfNotZero(std::int64_t num = 1) noexcept {
-        std::int64_t expected = ref_count_.load();
-        while (expected != 0) {
-            if (ref_count_.compare_exchange_weak(expected, expected + num)) {
+        std::int64_t expected = ref_count_.load(std::memory_order_relaxed);
+        while (!(expected & MERGED) || expected >= REF_ONE) {
+            if (ref_count_.compare_exchange_weak(expected, expected + num * REF_ONE, std::memory_order_relaxed)) {
                 return true;
             }
         }
@@ -48,9 +219,9 @@ public:
     }
 
     inline bool IncWeakIfNotZero(std::int64_t num = 1) noexcept {
-        std::int64_t expected = weak_count_.load();
+        std::int64_t expected = weak_count_.load(std::memory_order_relaxed);
         while (expected != 0) {
-            if (weak_count_.compare_exchange_weak(expected, expected + num)) {
+            if (weak_count_.compare_exchange_weak(expected, expected + num, std::memory_order_relaxed)) {
                 return true;
             }
         }
@@ -58,58 +229,213 @@ public:
     }
 
     inline void IncRef(std::int64_t num = 1) noexcept {
-        ref_count_.fetch_add(num);
+        if (biased_) [[unlikely]] {
+            if (TryBiasedIncRef(num)) {
+                return;
+            }
+        }
+        ref_count_.fetch_add(num * REF_ONE, std::memory_order_relaxed);
     }
 
     inline void IncWeak(std::int64_t num = 1) noexcept {
-        weak_count_.fetch_add(num);
+        weak_count_.fetch_add(num, std::memory_order_relaxed);
     }
 
     inline void DecRef(std::int64_t num = 1) {
-        if (ref_count_.fetch_sub(num) <= num) {
-            DestroyControlBlock();
+        if (biased_) [[unlikely]] {
+            BiasedDecRef(num);
+            return;
+        }
+        if (ref_count_.fetch_sub(num * REF_ONE, std::memory_order_acq_rel) - num * REF_ONE == MERGED) {
+            Retire();
         }
     }
 
     inline void DecWeak(std::int64_t num = 1) noexcept {
-        if (weak_count_.fetch_sub(num) <= num) {
-            this->retire();
+        if (weak_count_.fetch_sub(num, std::memory_order_acq_rel) <= num) {
+            DeleteControlBlock();
         }
     }
 
     std::int64_t use_count() const {
-        return ref_count_.load();
+        auto count = ref_count_.load(std::memory_order_relaxed) >> 2;
+        if (biased_) {
+            count += biased_->count.load(std::memory_order_relaxed);
+        }
+        return count;
     }
 
     virtual void *get() const noexcept = 0;
 
+protected:
+    /*
+      Called by the constructor of a biased control block before it's shared.
+    */
+    void MakeBiased(BiasedState &state) {
+        state.owner = BiasedOwner::Acquire();
+        state.count.store(1, std::memory_order_relaxed);
+        biased_ = &state;
+        ref_count_.store(0, std::memory_order_relaxed);
+    }
+
 private:
     virtual void DeleteValue() = 0;
 
     virtual void DeleteControlBlock() = 0;
 
+    void Retire() {
+        if (auto deferred = DeferredDestruction::get_current()) [[unlikely]] {
+            deferred->Push(this);
+        } else {
+            this->retire();
+        }
+    }
+
     void DestroyControlBlock() {
-        thread_local lu::forward_list<ControlBlock> list{};
-        thread_local bool in_progress{false};
-
-        list.push_front(*this);
-        if (!in_progress) {
-            in_progress = true;
-            while (!list.empty()) {
-                auto &popped = list.front();
-                list.pop_front();
-                popped.DeleteValue();
-                popped.DecWeak();
+        if (biased_) {
+            biased_->owner->Release();
+        }
+        DeleteValue();
+        DecWeak();
+    }
+
+    bool IsOwner() const noexcept {
+        return biased_->owner == BiasedOwner::get_current() && biased_->count.load(std::memory_order_relaxed) > 0;
+    }
+
+    bool TryBiasedIncRef(std::int64_t num) noexcept {
+        if (!IsOwner()) {
+            return false;
+        }
+        auto &count = biased_->count;
+        count.store(count.load(std::memory_order_relaxed) + num, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*
+      The owner may drop more references than it counted itself (taken by other threads and handed over),
+      the rest is taken from the shared count while merging.
+    */
+    bool TryBiasedDecRef(std::int64_t num) {
+        if (!IsOwner()) {
+            return false;
+        }
+        auto &count = biased_->count;
+        auto biased_count = count.load(std::memory_order_relaxed);
+        if (num < biased_count) [[likely]] {
+            count.store(biased_count - num, std::memory_order_relaxed);
+            return true;
+        }
+        count.store(0, std::memory_order_relaxed);
+        auto delta = MERGED - (num - biased_count) * REF_ONE;
+        if (ref_count_.fetch_add(delta, std::memory_order_acq_rel) + delta == MERGED) {
+            Retire();
+        }
+        return true;
+    }
+
+    /*
+      Other threads set QUEUED in the same CAS that makes the shared count negative, after that
+      the control block can't die before the owner has merged it, so it can be handed over safely.
+    */
+    void BiasedDecRef(std::int64_t num) {
+        if (TryBiasedDecRef(num)) {
+            return;
+        }
+        auto expected = ref_count_.load(std::memory_order_relaxed);
+        while (true) {
+            auto desired = expected - num * REF_ONE;
+            bool is_queueing = !(desired & (MERGED | QUEUED)) && desired < 0;
+            if (is_queueing) {
+                desired |= QUEUED;
             }
-            in_progress = false;
+            if (ref_count_.compare_exchange_weak(expected, desired, std::memory_order_acq_rel,
+                                                 std::memory_order_relaxed)) {
+                if (desired == MERGED) {
+                    Retire();
+                } else if (is_queueing) {
+                    biased_->owner->Push(this);
+                }
+                return;
+            }
+        }
+    }
+
+    /*
+      Run by the owner for a queued control block, or by the queueing thread once the owner has exited.
+    */
+    void MergeQueued() {
+        auto &count = biased_->count;
+        auto biased_count = count.load(std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        auto delta = biased_count * REF_ONE - QUEUED + (biased_count ? MERGED : 0);
+        if (ref_count_.fetch_add(delta, std::memory_order_acq_rel) + delta == MERGED) {
+            Retire();
         }
     }
 
 private:
-    std::atomic<std::int64_t> ref_count_{1};
+    std::atomic<std::int64_t> ref_count_{REF_ONE | MERGED};
     std::atomic<std::int64_t> weak_count_{1};
+    BiasedState *biased_{};
 };
 
+void DeferredDestruction::Push(ControlBlock *control_block) {
+    pending_.push_back(control_block);
+    if (pending_.size() >= DEFERRED_DESTRUCTION_BATCH && !is_flushing_) [[unlikely]] {
+        if (!HazardThreadData::get_reclaiming(&lu::get_default_domain())) {
+            Flush(max_per_call_);
+        }
+    }
+}
+
+/*
+  The batch is moved out first, the values destroyed by the scans it may trigger push to pending_.
+*/
+std::size_t DeferredDestruction::Flush(std::size_t max_count) {
+    if (is_flushing_ || pending_.empty()) {
+        return 0;
+    }
+    is_flushing_ = true;
+    auto count = std::min(max_count, pending_.size());
+    batch_.assign(pending_.end() - static_cast<std::ptrdiff_t>(count), pending_.end());
+    pending_.resize(pending_.size() - count);
+    ControlBlock::retire_batch(batch_.begin(), batch_.end());
+    batch_.clear();
+    is_flushing_ = false;
+    return count;
+}
+
+void BiasedOwner::Push(ControlBlock *control_block) {
+    auto head = queue_.load(std::memory_order_acquire);
+    do {
+        if (head == get_closed()) {
+            control_block->MergeQueued();
+            return;
+        }
+        control_block->biased_->next = head;
+    } while (!queue_.compare_exchange_weak(head, control_block, std::memory_order_release, std::memory_order_acquire));
+}
+
+void BiasedOwner::Drain() {
+    auto current = queue_.exchange(nullptr, std::memory_order_acquire);
+    while (current) {
+        auto next = current->biased_->next;
+        current->MergeQueued();
+        current = next;
+    }
+}
+
+void BiasedOwner::Exit() {
+    auto current = queue_.exchange(get_closed(), std::memory_order_acq_rel);
+    while (current) {
+        auto next = current->biased_->next;
+        current->MergeQueued();
+        current = next;
+    }
+    Release();
+}
+
 template<class ValueType, class Deleter, class Allocator>
 class OutplaceControlBlock : public ControlBlock {
 public:
@@ -148,11 +474,13 @@ private:
     allocator_type allocator_;
 };
 
-template<class ValueType, class Allocator>
+template<class ValueType, class Allocator, bool IsBiased = false>
 class InplaceControlBlock : public ControlBlock {
+    struct Unbiased {};
+
 public:
-    using allocator_type =
-            typename std::allocator_traits<Allocator>::template rebind_alloc<InplaceControlBlock<ValueType, Allocator>>;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<
+            InplaceControlBlock<ValueType, Allocator, IsBiased>>;
     using allocator_traits = std::allocator_traits<allocator_type>;
 
     using value_type = ValueType;
@@ -162,7 +490,11 @@ public:
     template<class... Args>
     InplaceControlBlock(const Allocator &allocator, Args &&...args)
         : allocator_(allocator)
-        , data_(std::forward<Args>(args)...) {}
+        , data_(std::forward<Args>(args)...) {
+        if constexpr (IsBiased) {
+            this->MakeBiased(biased_state_);
+        }
+    }
 
     void *get() const noexcept override {
         return data_.get_ptr();
@@ -182,6 +514,7 @@ private:
 private:
     AlignedStorage<ValueType> data_;
     allocator_type allocator_;
+    [[no_unique_address]] std::conditional_t<IsBiased, BiasedState, Unbiased> biased_state_{};
 };
 
 template<class ValueType, class Deleter, class Allocator>
@@ -203,9 +536,10 @@ OutplaceControlBlock<ValueType, Deleter, Allocator> *make_outplace_control_block
     return allocate_guard.release();
 }
 
-template<class ValueType, class Allocator, class... Args>
-InplaceControlBlock<ValueType, Allocator> *make_inplace_control_block(const Allocator &allocator, Args &&...args) {
-    using ControlBlock = InplaceControlBlock<ValueType, Allocator>;
+template<class ValueType, bool IsBiased = false, class Allocator, class... Args>
+InplaceControlBlock<ValueType, Allocator, IsBiased> *make_inplace_control_block(const Allocator &allocator,
+                                                                                Args &&...args) {
+    using ControlBlock = InplaceControlBlock<ValueType, Allocator, IsBiased>;
     using AllocatorType = typename std::allocator_traits<Allocator>::template rebind_alloc<ControlBlock>;
     using AllocatorTraits = std::allocator_traits<AllocatorType>;
 
@@ -536,6 +870,9 @@ class shared_ptr : public detail::StrongRefCountPointer<ValueType *, detail::Con
     template<class _ValueType, class... Args>
     friend shared_ptr<_ValueType> make_shared(Args &&...args);
 
+    template<class _ValueType, class Allocator, class... Args>
+    friend shared_ptr<_ValueType> alloc_shared_biased(const Allocator &allocator, Args &&...args);
+
     template<class>
     friend class shared_ptr;
 
@@ -779,12 +1116,12 @@ struct SharedPointerTraits {
         return ref_count_ptr(control_block);
     }
 
-    static void dec_ref(control_block_ptr control_block) {
-        control_block->DecRef();
+    static void dec_ref(control_block_ptr control_block, std::int64_t num = 1) {
+        control_block->DecRef(num);
     }
 
-    static void inc_ref(control_block_ptr control_block) {
-        control_block->IncRef();
+    static void inc_ref(control_block_ptr control_block, std::int64_t num = 1) {
+        control_block->IncRef(num);
     }
 
     static bool inc_ref_if_not_zero(control_block_ptr control_block) {
@@ -812,9 +1149,74 @@ shared_ptr<ValueType> make_shared(Args &&...args) {
     return alloc_shared<ValueType>(std::allocator<ValueType>{}, std::forward<Args>(args)...);
 }
 
+/*
+  Same as alloc_shared(), but the control block is biased to the calling thread: its copies and releases
+  don't need atomic read-modify-writes. Worth it when most copies stay on the creating thread.
+  Releases by other threads that outnumber their copies are merged by the owner at its next biased
+  allocation, when merge_biased_ref_counts() is called or when it exits.
+*/
+template<class ValueType, class Allocator = std::allocator<ValueType>, class... Args>
+shared_ptr<ValueType> alloc_shared_biased(const Allocator &allocator, Args &&...args) {
+    auto control_block = detail::make_inplace_control_block<ValueType, true>(allocator, std::forward<Args>(args)...);
+    auto raw_value_ptr = reinterpret_cast<ValueType *>(control_block->get());
+
+    shared_ptr<ValueType> result;
+
+    result.SetData(raw_value_ptr, control_block);
+    return result;
+}
+
+template<class ValueType, class... Args>
+shared_ptr<ValueType> make_shared_biased(Args &&...args) {
+    return alloc_shared_biased<ValueType>(std::allocator<ValueType>{}, std::forward<Args>(args)...);
+}
+
+/*
+  Merges the control blocks other threads have queued to the calling thread.
+*/
+inline void merge_biased_ref_counts() {
+    auto owner = detail::BiasedOwner::get_current();
+    if (owner) {
+        owner->Drain();
+    }
+}
+
+/*
+  Opt-in for the calling thread: dead control blocks are queued and retired in batches, at most
+  max_per_call at a time, so a large teardown is spread over the following calls. The queue is
+  flushed when the mode is disabled and when the thread exits.
+*/
+inline void enable_deferred_destruction(std::size_t max_per_call = detail::DEFAULT_DEFERRED_DESTRUCTION_LIMIT) {
+    detail::DeferredDestruction::Enable(max_per_call);
+}
+
+inline void disable_deferred_destruction() {
+    detail::DeferredDestruction::Disable();
+}
+
+/*
+  Retires up to max_count queued control blocks and returns how many were retired.
+*/
+inline std::size_t flush_deferred_destruction(std::size_t max_count = std::numeric_limits<std::size_t>::max()) {
+    auto queue = detail::DeferredDestruction::get_current();
+    return queue ? queue->Flush(max_count) : 0;
+}
+
 template<class ValueType>
 using atomic_shared_ptr = detail::AtomicRefCountPointer<detail::SharedPointerTraits<ValueType>>;
 
+/*
+  Returned by atomic_shared_ptr::load_guarded().
+*/
+template<class ValueType>
+using snapshot_ptr = detail::SnapshotPointer<detail::SharedPointerTraits<ValueType>>;
+
+/*
+  Same interface as atomic_shared_ptr, loads take a reference with one fetch_add and no hazard pointer.
+*/
+template<class ValueType>
+using split_atomic_shared_ptr = detail::SplitRefCountPointer<detail::SharedPointerTraits<ValueType>>;
+
 }// namespace lu
 
 #endif
\ No newline at end of file
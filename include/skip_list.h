@@ -0,0 +1,676 @@
+#ifndef __SKIP_LIST_H__
+#define __SKIP_LIST_H__
+
+#include "back_off.h"
+#include "hazard_pointer.h"
+#include "key_select.h"
+#include "marked_ptr.h"
+#include "utils.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace lu {
+namespace detail {
+
+static constexpr std::size_t SKIP_LIST_MAX_HEIGHT = 16;
+
+/*
+  Geometric with p = 1/4, enough levels for 4^16 keys.
+*/
+inline std::size_t get_random_height() noexcept {
+    static thread_local std::uint64_t state = reinterpret_cast<std::uintptr_t>(&state) | 1;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    auto random = state * 0x2545f4914f6cdd1d;
+    return std::min<std::size_t>(1 + std::countr_zero(random) / 2, SKIP_LIST_MAX_HEIGHT);
+}
+
+struct SkipListNodeDeleter {
+    template<class Node>
+    void operator()(Node *node) const {
+        Node::destroy(node);
+    }
+};
+
+/*
+  The links of the levels follow the node in the same allocation. A node is retired once all its
+  levels are accounted for: unlinked by a traversal or given up by the inserter before being linked.
+*/
+template<class ValueType>
+class SkipListNode : public lu::compact_hazard_pointer_obj_base<SkipListNode<ValueType>, SkipListNodeDeleter> {
+    using link_type = std::atomic<lu::marked_ptr<SkipListNode>>;
+
+public:
+    template<class... Args>
+    static SkipListNode *create(std::size_t height, Args &&...args) {
+        auto deallocate = [](void *memory) { ::operator delete(memory); };
+        auto memory = ::operator new(sizeof(SkipListNode) + height * sizeof(link_type));
+        DeleterGuard<void *, decltype(deallocate)> guard(memory, deallocate);
+        auto node = ::new (memory) SkipListNode(height, std::forward<Args>(args)...);
+        guard.release();
+        return node;
+    }
+
+    static void destroy(SkipListNode *node) noexcept {
+        node->~SkipListNode();
+        ::operator delete(node);
+    }
+
+    link_type &next(std::size_t level) noexcept {
+        assert(level < height_ && "Level is above the node");
+        return reinterpret_cast<link_type *>(this + 1)[level];
+    }
+
+    std::size_t get_height() const noexcept {
+        return height_;
+    }
+
+    /*
+      Returns true for the call that accounts for the last level.
+    */
+    bool release_levels(std::size_t num_of_levels) noexcept {
+        return num_of_linked_.fetch_sub(num_of_levels, std::memory_order_acq_rel) == num_of_levels;
+    }
+
+private:
+    template<class... Args>
+    explicit SkipListNode(std::size_t height, Args &&...args)
+        : value(std::forward<Args>(args)...)
+        , height_(height)
+        , num_of_linked_(height) {
+        for (std::size_t i = 0; i < height_; ++i) {
+            ::new (&next(i)) link_type();
+        }
+    }
+
+    ~SkipListNode() = default;
+
+public:
+    ValueType value;
+
+private:
+    const std::size_t height_;
+    std::atomic<std::size_t> num_of_linked_;
+};
+
+/*
+  Lock-free skip list (Fraser, Herlihy-Shavit). A node is removed by marking its links top-down,
+  the mark of the bottom link decides the erase; traversals unlink marked nodes level by level on
+  their way. Traversals hold three rotating guards, an insert additionally keeps the predecessor
+  and the successor of every level of the new node guarded.
+*/
+template<class ValueType, class KeyCompare, class KeySelect, class Backoff>
+class SkipList : private lu::detail::EmptyBaseHolder<KeyCompare>, private lu::detail::EmptyBaseHolder<KeySelect> {
+    using KeyCompareHolder = lu::detail::EmptyBaseHolder<KeyCompare>;
+    using KeySelectHolder = lu::detail::EmptyBaseHolder<KeySelect>;
+
+    using node_type = SkipListNode<ValueType>;
+    using node_ptr = node_type *;
+    using node_marked_ptr = lu::marked_ptr<node_type>;
+    using link_type = std::atomic<node_marked_ptr>;
+
+    using list_ptr = const SkipList *;
+
+    static constexpr std::size_t MAX_HEIGHT = SKIP_LIST_MAX_HEIGHT;
+
+    /*
+      preds and succs are filled for the lowest levels asked for; a predecessor that didn't move at
+      a level stays guarded by the guard of the level above. The node found at the bottom is cur.
+    */
+    struct position {
+        node_ptr cur;
+
+        std::array<node_ptr, MAX_HEIGHT> preds;
+        std::array<node_ptr, MAX_HEIGHT> succs;
+
+        lu::hazard_pointer pred_guard{lu::make_hazard_pointer()};
+        lu::hazard_pointer cur_guard{lu::make_hazard_pointer()};
+        lu::hazard_pointer next_guard{lu::make_hazard_pointer()};
+
+        std::array<lu::hazard_pointer, MAX_HEIGHT> pred_guards{};
+        std::array<lu::hazard_pointer, MAX_HEIGHT> succ_guards{};
+    };
+
+    template<class Types, bool IsConst>
+    class SkipListIterator {
+        template<class, class, class, class>
+        friend class SkipList;
+
+        class DummyNonConstIter;
+        using NonConstIter = std::conditional_t<IsConst, SkipListIterator<Types, false>, DummyNonConstIter>;
+
+        using list_ptr = typename Types::list_ptr;
+        using node_ptr = typename Types::node_ptr;
+        using node_marked_ptr = typename Types::node_marked_ptr;
+        using position = typename Types::position;
+
+    public:
+        using value_type = typename Types::value_type;
+        using difference_type = typename Types::difference_type;
+        using pointer = std::conditional_t<IsConst, typename Types::const_pointer, typename Types::pointer>;
+        using reference = std::conditional_t<IsConst, typename Types::const_reference, typename Types::reference>;
+        using iterator_category = std::forward_iterator_tag;
+
+    private:
+        SkipListIterator(lu::hazard_pointer guard, node_ptr current, list_ptr list) noexcept
+            : guard_(std::move(guard))
+            , current_(current)
+            , list_(list) {}
+
+    public:
+        SkipListIterator() = default;
+
+        SkipListIterator(const SkipListIterator &other) noexcept
+            : guard_(lu::make_hazard_pointer())
+            , current_(other.current_)
+            , list_(other.list_) {
+            guard_.reset_protection(current_);
+        }
+
+        SkipListIterator(const NonConstIter &other) noexcept
+            : guard_(lu::make_hazard_pointer())
+            , current_(other.current_)
+            , list_(other.list_) {
+            guard_.reset_protection(current_);
+        }
+
+        SkipListIterator(SkipListIterator &&other) noexcept {
+            swap(other);
+        }
+
+        SkipListIterator(NonConstIter &&other) noexcept {
+            swap(other);
+        }
+
+        SkipListIterator &operator=(const SkipListIterator &other) noexcept {
+            SkipListIterator temp(other);
+            swap(temp);
+            return *this;
+        }
+
+        SkipListIterator &operator=(const NonConstIter &other) noexcept {
+            SkipListIterator temp(other);
+            swap(temp);
+            return *this;
+        }
+
+        SkipListIterator &operator=(SkipListIterator &&other) noexcept {
+            SkipListIterator temp(std::move(other));
+            swap(temp);
+            return *this;
+        }
+
+        SkipListIterator &operator=(NonConstIter &&other) noexcept {
+            SkipListIterator temp(std::move(other));
+            swap(temp);
+            return *this;
+        }
+
+        SkipListIterator &operator++() noexcept {
+            increment();
+            return *this;
+        }
+
+        SkipListIterator operator++(int) noexcept {
+            SkipListIterator copy(*this);
+            increment();
+            return copy;
+        }
+
+        reference operator*() const noexcept {
+            return *this->operator->();
+        }
+
+        pointer operator->() const noexcept {
+            return &current_->value;
+        }
+
+        friend bool operator==(const SkipListIterator &left, const SkipListIterator &right) {
+            return left.current_ == right.current_;
+        }
+
+        friend bool operator!=(const SkipListIterator &left, const SkipListIterator &right) {
+            return !(left == right);
+        }
+
+        void swap(SkipListIterator &other) {
+            std::swap(guard_, other.guard_);
+            std::swap(current_, other.current_);
+            std::swap(list_, other.list_);
+        }
+
+    private:
+        /*
+          A removed node may not lead back into the list, the next value is looked up again, which
+          costs O(log n) here.
+        */
+        void increment() noexcept {
+            auto next_guard = lu::make_hazard_pointer();
+            auto next = next_guard.protect(current_->next(0), [](node_marked_ptr ptr) { return ptr.get(); });
+            if (next.get_bit()) {
+                position new_pos;
+                list_->find(list_->select_key(current_->value), new_pos, 0);
+                guard_ = std::move(new_pos.cur_guard);
+                current_ = new_pos.cur;
+            } else {
+                guard_ = std::move(next_guard);
+                current_ = next;
+            }
+        }
+
+    private:
+        lu::hazard_pointer guard_{};
+        node_ptr current_{};
+        list_ptr list_{};
+    };
+
+public:
+    using value_type = ValueType;
+    using key_type = typename KeySelect::type;
+
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    using compare = KeyCompare;
+    using key_select = KeySelect;
+
+    static constexpr bool is_key_value = !std::is_same_v<value_type, key_type>;
+
+    using guarded_ptr = std::conditional_t<is_key_value, lu::guarded_ptr<ValueType>, lu::guarded_ptr<const ValueType>>;
+
+    using iterator = SkipListIterator<SkipList, !is_key_value>;
+    using const_iterator = SkipListIterator<SkipList, true>;
+
+private:
+    link_type &get_link(node_ptr node, std::size_t level) const noexcept {
+        return node ? node->next(level) : const_cast<link_type &>(head_[level]);
+    }
+
+    std::size_t get_height() const noexcept {
+        return height_.load(std::memory_order_acquire);
+    }
+
+    void raise_height(std::size_t height) noexcept {
+        auto current = height_.load(std::memory_order_relaxed);
+        while (current < height && !height_.compare_exchange_weak(current, height, std::memory_order_release,
+                                                                  std::memory_order_relaxed)) {
+        }
+    }
+
+    /*
+      Releasing no levels doesn't retire the node: when its levels are gone already, the release
+      of the last one did.
+    */
+    static void release_levels(node_ptr node, std::size_t num_of_levels) {
+        if (num_of_levels && node->release_levels(num_of_levels)) {
+            node->retire();
+        }
+    }
+
+    decltype(auto) select_key(const value_type &value) const {
+        auto key_select = KeySelectHolder::get();
+        return key_select(value);
+    }
+
+    /*
+      Fills the predecessors and successors of the lowest num_of_levels levels, each kept protected by
+      the guards of its level. A predecessor a level didn't advance from comes from a level above, where
+      only the walking guard may protect it, so it is protected by the guard of the level as well.
+    */
+    bool find(const key_type &key, position &pos, std::size_t num_of_levels) const {
+        auto comp = KeyCompareHolder::get();
+        auto key_select = KeySelectHolder::get();
+        for (std::size_t level = 0; level < num_of_levels; ++level) {
+            if (pos.pred_guards[level].empty()) [[unlikely]] {
+                pos.pred_guards[level] = lu::make_hazard_pointer();
+                if (level) {
+                    pos.succ_guards[level] = lu::make_hazard_pointer();
+                }
+            }
+        }
+        Backoff back_off;
+
+    try_again:
+        node_ptr pred{};
+        node_marked_ptr cur{};
+        for (auto level = get_height(); level-- > 0;) {
+            bool is_advanced = false;
+            auto prev_pointer = &get_link(pred, level);
+            cur = pos.cur_guard.protect(*prev_pointer, [](node_marked_ptr ptr) { return ptr.get(); });
+            if (cur.get_bit()) {
+                back_off();
+                goto try_again;
+            }
+            while (cur) {
+                auto next = pos.next_guard.protect(cur->next(level), [](node_marked_ptr ptr) { return ptr.get(); });
+                if (prev_pointer->load().all() != cur.get()) {
+                    back_off();
+                    goto try_again;
+                }
+                if (next.get_bit()) {
+                    node_marked_ptr not_marked_cur(cur.get(), 0);
+                    if (!prev_pointer->compare_exchange_weak(not_marked_cur, node_marked_ptr(next.get(), 0))) {
+                        back_off();
+                        goto try_again;
+                    }
+                    release_levels(cur.get(), 1);
+                } else {
+                    if (!comp(key_select(cur->value), key)) {
+                        break;
+                    }
+                    pred = cur.get();
+                    prev_pointer = &pred->next(level);
+                    pos.pred_guard.swap(pos.cur_guard);
+                    is_advanced = true;
+                }
+                pos.cur_guard.swap(pos.next_guard);
+                cur = node_marked_ptr(next.get(), 0);
+            }
+            if (level < num_of_levels) {
+                pos.preds[level] = pred;
+                pos.succs[level] = cur.get();
+                if (is_advanced) {
+                    pos.pred_guards[level].swap(pos.pred_guard);
+                } else {
+                    pos.pred_guards[level].reset_protection(pred);
+                }
+                if (level) {
+                    pos.succ_guards[level].swap(pos.cur_guard);
+                }
+            }
+        }
+        pos.cur = cur.get();
+        return pos.cur && !comp(key, key_select(pos.cur->value));
+    }
+
+    bool find(const key_type &key, position &pos) const {
+        return find(key, pos, 0);
+    }
+
+    /*
+      The node is in the list once it's linked at the bottom, the levels above only speed up searches.
+      They are linked bottom-up and given up when the node is erased meanwhile.
+    */
+    bool insert_node(node_ptr new_node) {
+        auto key_select = KeySelectHolder::get();
+        auto height = new_node->get_height();
+        raise_height(height);
+
+        Backoff back_off;
+        position pos;
+        while (true) {
+            if (find(key_select(new_node->value), pos, height)) {
+                return false;
+            }
+            for (std::size_t level = 0; level < height; ++level) {
+                new_node->next(level).store(node_marked_ptr(pos.succs[level], 0), std::memory_order_relaxed);
+            }
+            node_marked_ptr cur(pos.succs[0], 0);
+            if (get_link(pos.preds[0], 0).compare_exchange_weak(cur, node_marked_ptr(new_node, 0))) {
+                break;
+            }
+            back_off();
+        }
+
+        if (height == 1) {
+            return true;
+        }
+        /*
+          Once a level is given up the node can be reclaimed, the guard keeps its key readable.
+        */
+        auto node_guard = lu::make_hazard_pointer();
+        node_guard.reset_protection(new_node);
+        for (std::size_t level = 1; level < height; ++level) {
+            while (true) {
+                auto &link = new_node->next(level);
+                auto next = link.load();
+                if (next.get_bit()) {
+                    release_levels(new_node, height - level);
+                    return true;
+                }
+                if (next.get() != pos.succs[level]
+                    && !link.compare_exchange_weak(next, node_marked_ptr(pos.succs[level], 0))) {
+                    continue;
+                }
+                node_marked_ptr succ(pos.succs[level], 0);
+                if (get_link(pos.preds[level], level).compare_exchange_weak(succ, node_marked_ptr(new_node, 0))) {
+                    break;
+                }
+                back_off();
+                if (!find(key_select(new_node->value), pos, height) || pos.cur != new_node) {
+                    release_levels(new_node, height - level);
+                    return true;
+                }
+            }
+            if (new_node->next(level).load().get_bit()) {
+                /*
+                  Erased while this level was linked, the eraser's traversal may have passed already.
+                */
+                release_levels(new_node, height - level - 1);
+                position cleanup;
+                find(key_select(new_node->value), cleanup);
+                return true;
+            }
+        }
+        return true;
+    }
+
+    /*
+      The erase belongs to whoever marks the bottom link, the traversal after it unlinks all the levels.
+    */
+    bool unlink(position &pos) {
+        auto node = pos.cur;
+        for (auto level = node->get_height() - 1; level > 0; --level) {
+            auto &link = node->next(level);
+            auto next = link.load();
+            while (!next.get_bit() && !link.compare_exchange_weak(next, node_marked_ptr(next.get(), 1))) {
+            }
+        }
+        auto &link = node->next(0);
+        auto next = link.load();
+        while (true) {
+            if (next.get_bit()) {
+                return false;
+            }
+            if (link.compare_exchange_weak(next, node_marked_ptr(next.get(), 1))) {
+                break;
+            }
+        }
+        position cleanup;
+        find(select_key(node->value), cleanup);
+        return true;
+    }
+
+public:
+    explicit SkipList(const compare &compare = {}, const key_select &key_select = {})
+        : KeyCompareHolder(compare)
+        , KeySelectHolder(key_select) {}
+
+    SkipList(const SkipList &other) = delete;
+
+    SkipList(SkipList &&other) = delete;
+
+    /*
+      Nothing runs concurrently, every linked level is dropped and a node is freed with its last one.
+    */
+    ~SkipList() {
+        for (std::size_t level = 0; level < MAX_HEIGHT; ++level) {
+            auto current = head_[level].load(std::memory_order_relaxed).get();
+            while (current) {
+                auto next = current->next(level).load(std::memory_order_relaxed).get();
+                if (current->release_levels(1)) {
+                    node_type::destroy(current);
+                }
+                current = next;
+            }
+        }
+    }
+
+public:
+    bool insert(const value_type &value) {
+        return emplace(value);
+    }
+
+    bool insert(value_type &&value) {
+        return emplace(std::move(value));
+    }
+
+    template<class... Args>
+    bool emplace(Args &&...args) {
+        node_ptr new_node = node_type::create(get_random_height(), std::forward<Args>(args)...);
+        if (!insert_node(new_node)) {
+            node_type::destroy(new_node);
+            return false;
+        }
+        return true;
+    }
+
+    bool erase(const key_type &value) {
+        position pos;
+        return find(value, pos) && unlink(pos);
+    }
+
+    guarded_ptr extract(const key_type &value) {
+        position pos;
+        if (find(value, pos) && unlink(pos)) {
+            return guarded_ptr(std::move(pos.cur_guard), &pos.cur->value);
+        }
+        return guarded_ptr();
+    }
+
+    void clear() {
+        auto key_select = KeySelectHolder::get();
+        while (true) {
+            auto first = begin();
+            if (first == end()) {
+                break;
+            }
+            erase(key_select(*first));
+        }
+    }
+
+    guarded_ptr find(const key_type &value) const {
+        position pos;
+        if (find(value, pos)) {
+            return guarded_ptr(std::move(pos.cur_guard), &pos.cur->value);
+        } else {
+            return guarded_ptr();
+        }
+    }
+
+    bool contains(const key_type &value) const {
+        position pos;
+        return find(value, pos);
+    }
+
+    bool empty() const {
+        return !head_[0].load().get();
+    }
+
+    /*
+      Start of a range scan: the first value not less than the key.
+    */
+    iterator lower_bound(const key_type &value) {
+        position pos;
+        find(value, pos);
+        return iterator(std::move(pos.cur_guard), pos.cur, this);
+    }
+
+    const_iterator lower_bound(const key_type &value) const {
+        position pos;
+        find(value, pos);
+        return const_iterator(std::move(pos.cur_guard), pos.cur, this);
+    }
+
+    iterator begin() {
+        auto head_guard = lu::make_hazard_pointer();
+        auto head = head_guard.protect(head_[0], [](node_marked_ptr ptr) { return ptr.get(); });
+        return iterator(std::move(head_guard), head, this);
+    }
+
+    iterator end() {
+        return iterator();
+    }
+
+    const_iterator cbegin() const {
+        auto head_guard = lu::make_hazard_pointer();
+        auto head = head_guard.protect(head_[0], [](node_marked_ptr ptr) { return ptr.get(); });
+        return const_iterator(std::move(head_guard), head, this);
+    }
+
+    const_iterator cend() const {
+        return const_iterator();
+    }
+
+    const_iterator begin() const {
+        return cbegin();
+    }
+
+    const_iterator end() const {
+        return cend();
+    }
+
+private:
+    std::array<link_type, MAX_HEIGHT> head_{};
+    std::atomic<std::size_t> height_{1};
+};
+
+struct SkipListDefaults {
+    using compare = void;
+    using backoff = void;
+};
+
+}// namespace detail
+}// namespace lu
+
+namespace lu {
+namespace detail {
+
+template<class ValueType, class... Options>
+struct make_skip_list_set {
+    using pack_options = typename GetPackOptions<SkipListDefaults, Options...>::type;
+
+    using compare = typename GetOptionOrDefault<typename pack_options::compare, std::less<const ValueType>>::type;
+    using backoff = typename GetOptionOrDefault<typename pack_options::backoff, lu::none_backoff>::type;
+    using key_select = SetKeySelect<ValueType>;
+
+    using type = SkipList<ValueType, compare, key_select, backoff>;
+};
+
+template<class KeyType, class ValueType, class... Options>
+struct make_skip_list_map {
+    using pack_options = typename GetPackOptions<SkipListDefaults, Options...>::type;
+
+    using compare = typename GetOptionOrDefault<typename pack_options::compare, std::less<const KeyType>>::type;
+    using backoff = typename GetOptionOrDefault<typename pack_options::backoff, lu::none_backoff>::type;
+    using key_select = MapKeySelect<const KeyType, ValueType>;
+
+    using type = SkipList<std::pair<const KeyType, ValueType>, compare, key_select, backoff>;
+};
+
+}// namespace detail
+
+template<class ValueType, class... Options>
+using skip_list_set = typename detail::make_skip_list_set<ValueType, Options...>::type;
+
+template<class KeyType, class ValueType, class... Options>
+using skip_list_map = typename detail::make_skip_list_map<KeyType, ValueType, Options...>::type;
+
+}// namespace lu
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef __SPLIT_REF_COUNT_POINTER_H__
+#define __SPLIT_REF_COUNT_POINTER_H__
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace lu {
+namespace detail {
+
+/*
+  Atomic reference counted pointer with split (differential) reference counts. The control block
+  pointer shares a word with a local count kept in the upper 16 bits, which user space addresses
+  don't use on the supported 64-bit targets. Installing a control block reserves NUM_OF_RESERVED
+  references in it at once; a load takes one of them with a single fetch_add on the word and needs
+  neither a hazard pointer nor a CAS on the control block. When the local count gets high, a loader
+  reserves another batch and moves the local count back. The replaced control block gets
+  back the references no loader has taken. Because of the reservation use_count() of a loaded pointer
+  is only an upper bound while it's installed.
+*/
+template<class RefCountTraits>
+class SplitRefCountPointer {
+    using control_block_ptr = typename RefCountTraits::control_block_ptr;
+    using ref_count_ptr = typename RefCountTraits::ref_count_ptr;
+
+    static_assert(sizeof(control_block_ptr) == sizeof(std::uint64_t), "Split counts need 64-bit pointers");
+
+    static constexpr std::size_t COUNT_SHIFT = 48;
+    static constexpr std::uint64_t POINTER_MASK = (std::uint64_t{1} << COUNT_SHIFT) - 1;
+    static constexpr std::uint64_t ONE_LOCAL = std::uint64_t{1} << COUNT_SHIFT;
+
+    static constexpr std::int64_t NUM_OF_RESERVED = std::int64_t{1} << 15;
+    static constexpr std::int64_t REFILL_THRESHOLD = NUM_OF_RESERVED / 2;
+
+public:
+    static constexpr bool is_always_lock_free = true;
+
+private:
+    static std::memory_order get_default_failure(std::memory_order success) {
+        if (success == std::memory_order_acq_rel) {
+            return std::memory_order_acquire;
+        }
+        if (success == std::memory_order_release) {
+            return std::memory_order_relaxed;
+        }
+        return success;
+    }
+
+    static std::uint64_t to_bits(control_block_ptr ptr) noexcept {
+        auto bits = std::bit_cast<std::uint64_t>(ptr);
+        assert(!(bits & ~POINTER_MASK) && "Pointer uses the bits of the local count");
+        return bits;
+    }
+
+    static control_block_ptr to_pointer(std::uint64_t packed) noexcept {
+        return std::bit_cast<control_block_ptr>(packed & POINTER_MASK);
+    }
+
+    static std::int64_t to_count(std::uint64_t packed) noexcept {
+        return static_cast<std::int64_t>(packed >> COUNT_SHIFT);
+    }
+
+    static std::uint64_t install(ref_count_ptr &desired) noexcept {
+        auto desired_ptr = RefCountTraits::release_ptr(desired);
+        if (desired_ptr) {
+            RefCountTraits::inc_ref(desired_ptr, NUM_OF_RESERVED);
+        }
+        return to_bits(desired_ptr);
+    }
+
+    /*
+      Hands back the reserved references nobody has taken. With keep_owned the reference of the slot
+      itself is kept for the caller.
+    */
+    static void uninstall(std::uint64_t packed, bool keep_owned) noexcept {
+        auto ptr = to_pointer(packed);
+        if (ptr) {
+            auto unused = NUM_OF_RESERVED - to_count(packed) + (keep_owned ? 0 : 1);
+            if (unused) {
+                RefCountTraits::dec_ref(ptr, unused);
+            }
+        }
+    }
+
+public:
+    SplitRefCountPointer() = default;
+
+    SplitRefCountPointer(const SplitRefCountPointer &) = delete;
+
+    SplitRefCountPointer(SplitRefCountPointer &&) = delete;
+
+    ~SplitRefCountPointer() {
+        uninstall(packed_.load(std::memory_order_acquire), false);
+    }
+
+    SplitRefCountPointer &operator=(const SplitRefCountPointer &) = delete;
+
+    SplitRefCountPointer &operator=(SplitRefCountPointer &&) = delete;
+
+    SplitRefCountPointer &operator=(ref_count_ptr other) noexcept {
+        store(std::move(other));
+        return *this;
+    }
+
+    [[nodiscard]] bool is_lock_free() const noexcept {
+        return true;
+    }
+
+    void store(ref_count_ptr desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        auto old_packed = packed_.exchange(install(desired), order);
+        uninstall(old_packed, false);
+    }
+
+    ref_count_ptr load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        if (!to_pointer(packed_.load(std::memory_order_relaxed))) {
+            return {};
+        }
+        auto packed = packed_.fetch_add(ONE_LOCAL, order);
+        auto ptr = to_pointer(packed);
+        if (!ptr) [[unlikely]] {
+            return {};
+        }
+        if (to_count(packed) + 1 >= REFILL_THRESHOLD) [[unlikely]] {
+            refill(packed + ONE_LOCAL);
+        }
+        return RefCountTraits::create_ptr(ptr);
+    }
+
+    ref_count_ptr exchange(ref_count_ptr desired, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        auto old_packed = packed_.exchange(install(desired), order);
+        uninstall(old_packed, true);
+        return RefCountTraits::create_ptr(to_pointer(old_packed));
+    }
+
+    bool compare_exchange_weak(ref_count_ptr &expected, ref_count_ptr desired, std::memory_order success,
+                               std::memory_order failure) noexcept {
+        return compare_exchange(expected, desired, success, failure, true);
+    }
+
+    bool compare_exchange_strong(ref_count_ptr &expected, ref_count_ptr desired, std::memory_order success,
+                                 std::memory_order failure) noexcept {
+        return compare_exchange(expected, desired, success, failure, false);
+    }
+
+    bool compare_exchange_weak(ref_count_ptr &expected, ref_count_ptr desired,
+                               std::memory_order success = std::memory_order_seq_cst) noexcept {
+        return compare_exchange_weak(expected, desired, success, get_default_failure(success));
+    }
+
+    bool compare_exchange_strong(ref_count_ptr &expected, ref_count_ptr desired,
+                                 std::memory_order success = std::memory_order_seq_cst) noexcept {
+        return compare_exchange_strong(expected, desired, success, get_default_failure(success));
+    }
+
+private:
+    /*
+      The caller holds a reference taken from the batch, so the control block is alive here even if
+      the slot was overwritten meanwhile. The CAS only moves the count of the same installation back;
+      if the pointer has changed the batch is returned.
+    */
+    void refill(std::uint64_t packed) const noexcept {
+        auto ptr = to_pointer(packed);
+        RefCountTraits::inc_ref(ptr, REFILL_THRESHOLD);
+        while (to_pointer(packed) == ptr && to_count(packed) >= REFILL_THRESHOLD) {
+            auto refilled = packed - REFILL_THRESHOLD * ONE_LOCAL;
+            if (packed_.compare_exchange_weak(packed, refilled, std::memory_order_relaxed,
+                                              std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        RefCountTraits::dec_ref(ptr, REFILL_THRESHOLD);
+    }
+
+    bool compare_exchange(ref_count_ptr &expected, ref_count_ptr &desired, std::memory_order success,
+                          std::memory_order failure, bool is_weak) noexcept {
+        auto expected_ptr = RefCountTraits::get_control_block(expected);
+        auto packed = packed_.load(std::memory_order_relaxed);
+        if (to_pointer(packed) == expected_ptr) {
+            auto desired_packed = to_bits(RefCountTraits::get_control_block(desired));
+            auto desired_ptr = RefCountTraits::get_control_block(desired);
+            if (desired_ptr) {
+                RefCountTraits::inc_ref(desired_ptr, NUM_OF_RESERVED);
+            }
+            while (to_pointer(packed) == expected_ptr) {
+                if (packed_.compare_exchange_weak(packed, desired_packed, success, failure)) {
+                    RefCountTraits::release_ptr(desired);
+                    uninstall(packed, false);
+                    return true;
+                }
+                if (is_weak) {
+                    break;
+                }
+            }
+            if (desired_ptr) {
+                RefCountTraits::dec_ref(desired_ptr, NUM_OF_RESERVED);
+            }
+        }
+        expected = load();
+        return false;
+    }
+
+private:
+    mutable std::atomic<std::uint64_t> packed_{};
+};
+
+}// namespace detail
+}// namespace lu
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstddef>
 
 
 namespace lu {
@@ -64,6 +65,52 @@ public:
 private:
     using list_pointer = const thread_local_list *;
 
+    /*
+      Small direct-mapped cache in front of ThreadLocalOwner. It is trivially destructible,
+      so accessing it doesn't go through a thread_local initialization guard, and a hit costs
+      one compare instead of a hash lookup in the owner.
+    */
+    class ThreadLocalCache {
+        static constexpr std::size_t num_of_entries = 4;
+
+        struct Entry {
+            list_pointer key;
+            pointer value;
+        };
+
+    public:
+        pointer get_entry(list_pointer key) const noexcept {
+            auto &entry = entries_[get_index(key)];
+            if (entry.key == key) [[likely]] {
+                return entry.value;
+            }
+            return {};
+        }
+
+        void set_entry(list_pointer key, pointer value) noexcept {
+            auto &entry = entries_[get_index(key)];
+            entry.key = key;
+            entry.value = value;
+        }
+
+        void invalidate(list_pointer key) noexcept {
+            auto &entry = entries_[get_index(key)];
+            if (entry.key == key) {
+                entry.key = {};
+                entry.value = {};
+            }
+        }
+
+    private:
+        static std::size_t get_index(list_pointer key) noexcept {
+            detail::PointerHash hash;
+            return hash(key) & (num_of_entries - 1);
+        }
+
+    private:
+        Entry entries_[num_of_entries];
+    };
+
     struct KeyOfValue {
         using type = list_pointer;
 
@@ -119,7 +166,9 @@ private:
             auto list = reinterpret_cast<list_pointer>(value.key);
             list->detacher_(&value);
             set_.erase(set_.iterator_to(value));
-            value.release();
+            get_cache().invalidate(list);
+            list->list_.release(value);
+            list->num_of_active_.fetch_sub(1, std::memory_order_relaxed);
         }
 
     private:
@@ -151,12 +200,18 @@ public:
     }
 
 private:
-    ThreadLocalOwner &get_owner() {
+    static ThreadLocalOwner &get_owner() {
         static thread_local ThreadLocalOwner owner;
         return owner;
     }
 
+    static ThreadLocalCache &get_cache() noexcept {
+        static thread_local ThreadLocalCache cache{};
+        return cache;
+    }
+
     pointer find_or_create() {
+        num_of_active_.fetch_add(1, std::memory_order_relaxed);
         auto found = list_.find_free();
         if (found != list_.end()) {
             return found.operator->();
@@ -168,6 +223,16 @@ private:
         }
     }
 
+    pointer get_thread_local_slow() {
+        auto &owner = get_owner();
+        auto result = owner.get_entry(this);
+        if (!result) {
+            result = find_or_create();
+            owner.attach(*result);
+        }
+        return result;
+    }
+
 public:
     void attach_thread() {
         auto &owner = get_owner();
@@ -183,15 +248,23 @@ public:
     }
 
     reference get_thread_local() {
-        auto &owner = get_owner();
-        auto result = owner.get_entry(this);
+        auto &cache = get_cache();
+        auto result = cache.get_entry(this);
         if (!result) [[unlikely]] {
-            result = find_or_create();
-            owner.attach(*result);
+            result = get_thread_local_slow();
+            cache.set_entry(this, result);
         }
         return *result;
     }
 
+    /*
+      Number of threads attached to the list, the value is approximate while threads are
+      attaching or detaching concurrently.
+    */
+    std::size_t num_of_active() const noexcept {
+        return num_of_active_.load(std::memory_order_relaxed);
+    }
+
     iterator begin() noexcept {
         return list_.begin();
     }
@@ -217,7 +290,8 @@ public:
     }
 
 private:
-    ActiveList list_{};
+    mutable ActiveList list_{};
+    mutable std::atomic<std::size_t> num_of_active_{};
     lu::fixed_size_function<pointer(), 64> creator_;
     lu::fixed_size_function<void(pointer), 64> deleter_;
     lu::fixed_size_function<void(pointer), 64> detacher_;
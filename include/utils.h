@@ -1,6 +1,7 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -18,6 +19,16 @@ template<std::size_t argument, std::size_t base>
 constexpr std::size_t log<argument, base, true> = 0;
 
 
+/*
+  Fixed instead of std::hardware_destructive_interference_size, which isn't ABI stable
+  and makes GCC warn when it's used in a header.
+*/
+static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+constexpr std::size_t align_up(std::size_t size, std::size_t alignment) noexcept {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
 struct PointerHash {
     template<class T>
     std::size_t operator()(T *p) const noexcept {
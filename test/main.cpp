@@ -1,9 +1,13 @@
+#include <concurrent_unordered_map.h>
 #include <hazard_pointer.h>
 #include <intrusive/forward_list.h>
 #include <intrusive/hashtable.h>
 #include <intrusive/unordered_set.h>
 #include <marked_shared_ptr.h>
+#include <mpmc_queue.h>
+#include <pool_allocator.h>
 #include <shared_ptr.h>
+#include <skip_list.h>
 
 #include "back_off.h"
 #include "fixed_size_function.h"
@@ -17,13 +21,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <numeric>
 #include <ostream>
 #include <random>
 #include <span>
@@ -37,25 +44,62 @@
 #include <vector>
 
 
-template<typename TContainer>
-void stressTest(int actions, int threads) {
+/*
+  Bounded containers may refuse a push and have try_ operations only.
+*/
+template<class TContainer>
+bool stressPush(TContainer &container, int value) {
+    if constexpr (requires { container.try_push(value); }) {
+        return container.try_push(value);
+    } else {
+        container.push(value);
+        return true;
+    }
+}
+
+template<class TContainer>
+auto stressPop(TContainer &container) {
+    if constexpr (requires { container.try_pop(); }) {
+        return container.try_pop();
+    } else {
+        return container.pop();
+    }
+}
+
+/*
+  Containers that can be drained at once are, now and then, instead of popping a single value.
+*/
+template<class TContainer>
+void stressPopAll(TContainer &container, std::vector<int> &extracted) {
+    if constexpr (requires { container.pop_all(std::back_inserter(extracted)); }) {
+        if (rand() % 16 == 0) {
+            container.pop_all(std::back_inserter(extracted));
+            return;
+        }
+    }
+    auto a = stressPop(container);
+    if (a) {
+        extracted.push_back(*a);
+    }
+}
+
+template<typename TContainer, class... Args>
+void stressTest(int actions, int threads, Args &&...args) {
     std::vector<std::thread> workers;
     workers.reserve(threads);
     std::vector<std::vector<int>> generated(threads);
     std::vector<std::vector<int>> extracted(threads);
-    TContainer container;
+    TContainer container(std::forward<Args>(args)...);
     for (int i = 0; i < threads; i++) {
         workers.emplace_back([i, actions, &container, &generated, &extracted, threads]() {
             for (int j = 0; j < actions / threads; j++) {
                 if (rand() % 2) {
                     int a = rand();
-                    container.push(a);
-                    generated[i].push_back(a);
-                } else {
-                    auto a = container.pop();
-                    if (a) {
-                        extracted[i].push_back(*a);
+                    if (stressPush(container, a)) {
+                        generated[i].push_back(a);
                     }
+                } else {
+                    stressPopAll(container, extracted[i]);
                 }
             }
         });
@@ -80,7 +124,7 @@ void stressTest(int actions, int threads) {
     }
 
     while (true) {
-        auto a = container.pop();
+        auto a = stressPop(container);
         if (a) {
             all_extracted.push_back(*a);
         } else {
@@ -118,6 +162,7 @@ void abstractStressTest(Func &&func) {
         std::cout << std::endl;
         lu::detach_thread();
     }
+    lu::cleanup();
     if (lu::get_default_domain().num_of_reclaimed() != lu::get_default_domain().num_of_retired()) {
         throw std::runtime_error("the number of reclaimed and retired must be equal: "
                                  + std::to_string(lu::get_default_domain().num_of_reclaimed()) + ", "
@@ -125,6 +170,678 @@ void abstractStressTest(Func &&func) {
     }
 }
 
+template<class Domain>
+void checkReclamation(const std::string &scheme, Domain &domain) {
+    if constexpr (requires { domain.cleanup(); }) {
+        domain.cleanup();
+    }
+    domain.detach_thread();
+    if (domain.num_of_reclaimed() != domain.num_of_retired()) {
+        throw std::runtime_error(scheme + ": the number of reclaimed and retired must be equal: "
+                                 + std::to_string(domain.num_of_reclaimed()) + ", "
+                                 + std::to_string(domain.num_of_retired()));
+    }
+}
+
+/*
+  The same stack and queue over each reclamation scheme: hazard pointers, epochs and hazard eras.
+  The hazard pointer ones also run over domains set up to take the less common paths.
+*/
+void reclamationStressTest(int actions, int threads) {
+    using back_off = lu::none_backoff;
+
+    stressTest<lu::hp::TreiberStack<int, back_off>>(actions, threads);
+    stressTest<lu::hp::TreiberStack<int, lu::exponential_backoff<>, 4>>(actions, threads);
+    stressTest<lu::hp::MSQueue<int, back_off>>(actions, threads);
+    checkReclamation("hazard pointers", lu::get_default_domain());
+
+    stressTest<lu::ebr::TreiberStack<int, back_off>>(actions, threads);
+    stressTest<lu::ebr::MSQueue<int, back_off>>(actions, threads);
+    checkReclamation("epochs", lu::get_default_epoch_domain());
+
+    stressTest<lu::he::TreiberStack<int, back_off>>(actions, threads);
+    stressTest<lu::he::MSQueue<int, back_off>>(actions, threads);
+    checkReclamation("hazard eras", lu::get_default_era_domain());
+
+    lu::hazard_pointer_domain snapshot_domain(lu::DEFAULT_NUM_OF_RECORDS, lu::DEFAULT_NUM_OF_RETIRES,
+                                              lu::DEFAULT_SCAN_THRESHOLD);
+    snapshot_domain.set_snapshot_threshold(0);
+    stressTest<lu::hp::TreiberStack<int, back_off>>(actions, threads, snapshot_domain);
+    stressTest<lu::hp::MSQueue<int, back_off>>(actions, threads, snapshot_domain);
+    checkReclamation("snapshot scan", snapshot_domain);
+
+    lu::hazard_pointer_domain reclaimer_domain(lu::DEFAULT_NUM_OF_RECORDS, lu::DEFAULT_NUM_OF_RETIRES,
+                                               lu::DEFAULT_SCAN_THRESHOLD);
+    reclaimer_domain.start_reclaimer({.num_of_batches = 4, .interval = std::chrono::milliseconds(1)});
+    stressTest<lu::hp::TreiberStack<int, back_off>>(actions, threads, reclaimer_domain);
+    stressTest<lu::hp::MSQueue<int, back_off>>(actions, threads, reclaimer_domain);
+    reclaimer_domain.flush();
+    if (reclaimer_domain.num_of_reclaimed() != reclaimer_domain.num_of_retired()) {
+        throw std::runtime_error("reclaimer thread: flush left "
+                                 + std::to_string(reclaimer_domain.num_of_retired()
+                                                  - reclaimer_domain.num_of_reclaimed())
+                                 + " objects retired");
+    }
+    reclaimer_domain.stop_reclaimer();
+    checkReclamation("reclaimer thread", reclaimer_domain);
+
+    // A pop of the queue holds two hazard pointers, the second one comes from an overflow block.
+    lu::static_hazard_pointer_domain<1, 16, 16> static_domain;
+    stressTest<lu::hp::TreiberStack<int, back_off>>(actions, threads, static_domain);
+    stressTest<lu::hp::MSQueue<int, back_off>>(actions, threads, static_domain);
+    checkReclamation("static hazard pointers", static_domain);
+
+    stressTest<lu::mpmc_queue<int>>(actions, threads);
+    stressTest<lu::mpmc_queue<int, 4>>(actions, threads);
+    stressTest<lu::bounded_mpmc_queue<int>>(actions, threads);
+    checkReclamation("segmented queue", lu::get_default_domain());
+}
+
+/*
+  Stack and queue over a domain with a small blocking retire budget. Every thread publishes its retires
+  a quantum at a time and scans at its threshold, so the pending count may pass the budget by that much
+  per thread but no further.
+*/
+void retireBudgetTest(int actions, int threads) {
+    static constexpr std::size_t max_pending = 32;
+
+    lu::hazard_pointer_domain domain(lu::DEFAULT_NUM_OF_RECORDS, lu::DEFAULT_NUM_OF_RETIRES, lu::DEFAULT_SCAN_THRESHOLD);
+    domain.set_retire_budget({.max_pending = max_pending, .policy = lu::budget_policy::block});
+
+    std::atomic<bool> done{};
+    std::size_t max_observed{};
+    std::thread monitor([&domain, &done, &max_observed] {
+        while (!done.load()) {
+            max_observed = std::max(max_observed, domain.get_stats().num_of_pending);
+            std::this_thread::yield();
+        }
+    });
+    stressTest<lu::hp::TreiberStack<int, lu::none_backoff>>(actions, threads, domain);
+    stressTest<lu::hp::MSQueue<int, lu::none_backoff>>(actions, threads, domain);
+    done.store(true);
+    monitor.join();
+
+    auto bound = max_pending + threads * (lu::detail::BUDGET_QUANTUM + lu::DEFAULT_SCAN_THRESHOLD);
+    if (max_observed > bound) {
+        throw std::runtime_error("retire budget: " + std::to_string(max_observed) + " objects pending, bound is "
+                                 + std::to_string(bound));
+    }
+    checkReclamation("retire budget", domain);
+}
+
+/*
+  A chain of shared_ptrs dropped at once with deferred destruction: each flush hands over at most
+  max_per_call control blocks and the whole chain is gone once the queue is flushed.
+*/
+void deferredDestructionTest(int length) {
+    struct ChainNode {
+        explicit ChainNode(std::atomic<int> &alive)
+            : alive(alive) {
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~ChainNode() {
+            alive.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        std::atomic<int> &alive;
+        lu::shared_ptr<ChainNode> next;
+    };
+
+    std::atomic<int> alive{};
+    lu::enable_deferred_destruction(256);
+    {
+        lu::shared_ptr<ChainNode> head;
+        for (int i = 0; i < length; ++i) {
+            auto node = lu::make_shared<ChainNode>(alive);
+            node->next = std::move(head);
+            head = std::move(node);
+        }
+    }
+    while (lu::flush_deferred_destruction(256)) {
+        lu::cleanup();
+    }
+    lu::disable_deferred_destruction();
+    lu::cleanup();
+    if (alive.load() != 0) {
+        throw std::runtime_error("deferred destruction left " + std::to_string(alive.load()) + " nodes alive");
+    }
+    checkReclamation("deferred destruction", lu::get_default_domain());
+}
+
+/*
+  Nodes owning the next one retire it from their destructor into an epoch domain with a small threshold,
+  so the deleters retire while a limbo is being reclaimed. Flushing unrolls the chains one node per walk,
+  the chains retired last are left to the destructor of the domain.
+*/
+void epochOwnedChainTest(int num_of_chains, int length) {
+    struct ChainNode : lu::compact_hazard_pointer_obj_base<ChainNode> {
+        ChainNode(lu::epoch_domain &domain, std::atomic<int> &alive)
+            : domain(domain)
+            , alive(alive) {
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~ChainNode() {
+            if (next) {
+                next->retire({}, domain);
+            }
+            alive.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        lu::epoch_domain &domain;
+        std::atomic<int> &alive;
+        ChainNode *next{};
+    };
+
+    auto retire_chains = [num_of_chains, length](lu::epoch_domain &domain, std::atomic<int> &alive) {
+        for (int i = 0; i < num_of_chains; ++i) {
+            ChainNode *head{};
+            for (int j = 0; j < length; ++j) {
+                auto node = new ChainNode(domain, alive);
+                node->next = head;
+                head = node;
+            }
+            head->retire({}, domain);
+        }
+    };
+
+    std::atomic<int> alive{};
+    {
+        lu::epoch_domain domain(8);
+        retire_chains(domain, alive);
+        while (alive.load() != 0) {
+            domain.flush();
+        }
+        checkReclamation("epoch owned chains", domain);
+        retire_chains(domain, alive);
+        domain.detach_thread();
+    }
+    if (alive.load() != 0) {
+        throw std::runtime_error("epoch domain left " + std::to_string(alive.load()) + " nodes alive");
+    }
+}
+
+/*
+  Value counting its live instances, a destroyed one has a negative value.
+*/
+struct Tracked {
+    Tracked(std::atomic<int> &alive, int value)
+        : alive(alive)
+        , value(value) {
+        alive.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~Tracked() {
+        value = -1;
+        alive.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<int> &alive;
+    int value;
+};
+
+void checkAlive(const std::string &scheme, std::atomic<int> &alive) {
+    lu::cleanup();
+    if (alive.load() != 0) {
+        throw std::runtime_error(scheme + ": " + std::to_string(alive.load()) + " objects alive");
+    }
+}
+
+/*
+  Writers store, exchange and compare-exchange the slot while readers load it. Between the rounds one value
+  stays installed while readers load it far more often than a batch of reserved references, some of them
+  holding all their loads at once, so the local count is moved back into the control block many times.
+*/
+void splitAtomicPointerTest(int num_of_rounds, int threads) {
+    static constexpr int num_of_loads = 3 * (1 << 15);
+
+    std::atomic<int> alive{};
+    {
+        lu::split_atomic_shared_ptr<Tracked> slot;
+        for (int round = 0; round < num_of_rounds; ++round) {
+            slot.store(lu::make_shared<Tracked>(alive, round));
+            std::vector<std::thread> readers;
+            for (int i = 0; i < threads; ++i) {
+                readers.emplace_back([&slot, round, i] {
+                    std::vector<lu::shared_ptr<Tracked>> held;
+                    for (int j = 0; j < num_of_loads; ++j) {
+                        auto value = slot.load();
+                        if (value->value != round) {
+                            throw std::runtime_error("split pointer: loaded " + std::to_string(value->value)
+                                                     + " in round " + std::to_string(round));
+                        }
+                        if (i % 2) {
+                            held.push_back(std::move(value));
+                        }
+                    }
+                });
+            }
+            for (auto &reader: readers) {
+                reader.join();
+            }
+
+            std::atomic<bool> done{};
+            std::vector<std::thread> workers;
+            for (int i = 0; i < threads; ++i) {
+                workers.emplace_back([&slot, &done, &alive, i] {
+                    if (i % 2) {
+                        while (!done.load()) {
+                            auto value = slot.load();
+                            if (value && value->value < 0) {
+                                throw std::runtime_error("split pointer: loaded a destroyed value");
+                            }
+                        }
+                        return;
+                    }
+                    for (int j = 0; j < 10000; ++j) {
+                        switch (j % 3) {
+                            case 0:
+                                slot.store(lu::make_shared<Tracked>(alive, j));
+                                break;
+                            case 1:
+                                slot.exchange(lu::make_shared<Tracked>(alive, j));
+                                break;
+                            default:
+                                auto expected = slot.load();
+                                slot.compare_exchange_strong(expected, lu::make_shared<Tracked>(alive, j));
+                                break;
+                        }
+                    }
+                });
+            }
+            for (int i = 0; i < threads; i += 2) {
+                workers[i].join();
+            }
+            done.store(true);
+            for (int i = 1; i < threads; i += 2) {
+                workers[i].join();
+            }
+        }
+        slot.store({});
+    }
+    checkAlive("split pointer", alive);
+}
+
+/*
+  Readers borrow the value with load_guarded() and now and then upgrade the snapshot to a reference they
+  keep after the snapshot is gone, while writers replace the value.
+*/
+void loadGuardedTest(int num_of_stores, int threads) {
+    std::atomic<int> alive{};
+    {
+        lu::atomic_shared_ptr<Tracked> slot;
+        slot.store(lu::make_shared<Tracked>(alive, 0));
+        std::atomic<bool> done{};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < threads; ++i) {
+            readers.emplace_back([&slot, &done] {
+                std::vector<lu::shared_ptr<Tracked>> kept;
+                for (int j = 0; !done.load(); ++j) {
+                    auto snapshot = slot.load_guarded();
+                    if (snapshot->value < 0) {
+                        throw std::runtime_error("load_guarded: borrowed a destroyed value");
+                    }
+                    if (j % 8 == 0) {
+                        if (auto upgraded = snapshot.upgrade()) {
+                            snapshot.reset();
+                            kept.push_back(std::move(upgraded));
+                        }
+                    }
+                    if (kept.size() > 64) {
+                        kept.clear();
+                    }
+                }
+                for (auto &value: kept) {
+                    if (value->value < 0) {
+                        throw std::runtime_error("load_guarded: upgraded value was destroyed");
+                    }
+                }
+            });
+        }
+        std::thread writer([&slot, &alive, num_of_stores] {
+            for (int i = 1; i <= num_of_stores; ++i) {
+                slot.store(lu::make_shared<Tracked>(alive, i));
+            }
+        });
+        writer.join();
+        done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+        slot.store({});
+    }
+    checkAlive("load_guarded", alive);
+}
+
+/*
+  Producers allocate from their pools and exit, consumers free the blocks of every producer, so the blocks
+  go back through remote batches to caches whose threads are gone. The next round of producers adopts
+  those caches. No block may be handed out twice while the blocks of a round are alive.
+  Then nodes allocated with pool_new() are retired with pool_deleter and reclaimed by whichever thread
+  scans, while readers protect them.
+*/
+void poolAllocatorTest(int num_of_objects, int threads) {
+    struct Payload {
+        int producer;
+        int index;
+    };
+
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::vector<Payload *>> produced(threads);
+        std::vector<std::thread> producers;
+        for (int i = 0; i < threads; ++i) {
+            producers.emplace_back([&produced, num_of_objects, i] {
+                for (int j = 0; j < num_of_objects; ++j) {
+                    produced[i].push_back(lu::pool_new<Payload>(i, j));
+                }
+            });
+        }
+        for (auto &producer: producers) {
+            producer.join();
+        }
+
+        std::vector<Payload *> all;
+        for (auto &objects: produced) {
+            all.insert(all.end(), objects.begin(), objects.end());
+        }
+        std::sort(all.begin(), all.end());
+        if (std::adjacent_find(all.begin(), all.end()) != all.end()) {
+            throw std::runtime_error("pool allocator handed out a block twice");
+        }
+
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < threads; ++i) {
+            consumers.emplace_back([&produced, threads, i] {
+                auto &objects = produced[(i + 1) % threads];
+                for (int j = 0; j < static_cast<int>(objects.size()); ++j) {
+                    if (objects[j]->producer != (i + 1) % threads || objects[j]->index != j) {
+                        throw std::runtime_error("pool allocator block was overwritten");
+                    }
+                    lu::pool_deleter<Payload>()(objects[j]);
+                }
+            });
+        }
+        for (auto &consumer: consumers) {
+            consumer.join();
+        }
+    }
+
+    struct PoolNode : lu::hazard_pointer_obj_base<PoolNode, lu::pool_deleter<PoolNode>> {
+        PoolNode(std::atomic<int> &alive, int value)
+            : tracked(alive, value) {}
+
+        Tracked tracked;
+    };
+
+    std::atomic<int> alive{};
+    std::atomic<PoolNode *> slot{};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&slot, &alive, num_of_objects, i] {
+            auto guard = lu::make_hazard_pointer();
+            for (int j = 0; j < num_of_objects; ++j) {
+                if (i % 2) {
+                    auto node = guard.protect(slot);
+                    if (node && node->tracked.value < 0) {
+                        throw std::runtime_error("pool_deleter: protected node was destroyed");
+                    }
+                    continue;
+                }
+                auto old = slot.exchange(lu::pool_new<PoolNode>(alive, j));
+                if (old) {
+                    old->retire();
+                }
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    if (auto last = slot.exchange(nullptr)) {
+        last->retire();
+    }
+    checkAlive("pool_deleter", alive);
+}
+
+/*
+  Biased control blocks shared with other threads: released there both before and after the owner releases
+  its own references, outliving an owner that exited first, and reached through an atomic_shared_ptr and
+  weak_ptr locks while their owner replaces them. Nothing may be alive once the owner has merged its queue
+  and the domain is cleaned up.
+*/
+void biasedRefCountTest(int num_of_objects, int threads) {
+    std::atomic<int> alive{};
+    auto check = [&alive](const std::string &scenario) {
+        lu::merge_biased_ref_counts();
+        checkAlive("biased " + scenario, alive);
+    };
+
+    {
+        std::vector<lu::shared_ptr<Tracked>> owned;
+        std::vector<std::vector<lu::shared_ptr<Tracked>>> handed(threads);
+        for (int i = 0; i < num_of_objects; ++i) {
+            owned.push_back(lu::make_shared_biased<Tracked>(alive, i));
+            handed[i % threads].push_back(owned.back());
+        }
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&handed, i] { handed[i].clear(); });
+        }
+        for (int i = 0; i < num_of_objects; i += 2) {
+            owned[i] = {};
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        owned.clear();
+    }
+    check("handoff");
+
+    {
+        std::vector<lu::shared_ptr<Tracked>> orphans;
+        std::thread owner([&alive, &orphans, num_of_objects] {
+            for (int i = 0; i < num_of_objects; ++i) {
+                auto value = lu::make_shared_biased<Tracked>(alive, i);
+                orphans.push_back(value);
+            }
+        });
+        owner.join();
+        orphans.clear();
+    }
+    check("owner exit");
+
+    {
+        lu::atomic_shared_ptr<Tracked> slot;
+        std::atomic<bool> done{};
+        std::thread writer([&alive, &slot, &done, num_of_objects] {
+            for (int i = 0; i < num_of_objects; ++i) {
+                slot.store(lu::make_shared_biased<Tracked>(alive, i));
+            }
+            slot.store({});
+            done.store(true);
+        });
+        std::vector<std::thread> readers;
+        for (int i = 0; i < threads; ++i) {
+            readers.emplace_back([&slot, &done] {
+                while (!done.load()) {
+                    lu::weak_ptr<Tracked> weak(slot.load());
+                    if (auto locked = weak.lock()) {
+                        if (locked->value < 0) {
+                            throw std::runtime_error("biased weak_ptr locked a destroyed value");
+                        }
+                    }
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader: readers) {
+            reader.join();
+        }
+    }
+    check("weak_ptr lock");
+}
+
+/*
+  Writers bulk-load overlapping shuffled ranges and, once all are loaded, erase some of the keys while
+  a reader walks guarded ranges, which must come out strictly ascending. At the end the list holds every key
+  that was loaded and not erased.
+*/
+void orderedListRangeTest(int num_of_keys, int threads) {
+    lu::ordered_list_set<int> set;
+    std::atomic<bool> done{};
+    std::thread reader([&set, &done] {
+        while (!done.load()) {
+            int prev = -1;
+            for (auto &value: set.guarded_range()) {
+                if (value <= prev) {
+                    throw std::runtime_error("guarded range is out of order: " + std::to_string(prev) + ", "
+                                             + std::to_string(value));
+                }
+                prev = value;
+            }
+        }
+    });
+    std::atomic<int> num_of_loaded{};
+    std::vector<std::thread> writers;
+    for (int i = 0; i < threads; ++i) {
+        writers.emplace_back([&set, &num_of_loaded, num_of_keys, threads, i] {
+            std::vector<int> keys(num_of_keys);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(i));
+            set.insert_range(keys.begin(), keys.end());
+            num_of_loaded.fetch_add(1);
+            while (num_of_loaded.load() < threads) {
+                std::this_thread::yield();
+            }
+            for (int key = i; key < num_of_keys; key += 2 * threads) {
+                set.erase(key);
+            }
+        });
+    }
+    for (auto &writer: writers) {
+        writer.join();
+    }
+    done.store(true);
+    reader.join();
+
+    std::vector<int> expected;
+    for (int key = 0; key < num_of_keys; ++key) {
+        if (key % (2 * threads) >= threads) {
+            expected.push_back(key);
+        }
+    }
+    std::vector<int> actual;
+    for (auto &value: set.guarded_range()) {
+        actual.push_back(value);
+    }
+    if (actual != expected) {
+        throw std::runtime_error("insert_range: expected " + std::to_string(expected.size()) + " keys, got "
+                                 + std::to_string(actual.size()));
+    }
+}
+
+/*
+  Writers erase keys and insert them again while readers walk guarded ranges. A reader whose last node
+  is removed looks its key up again and may find the new node with that key, which must not come out twice.
+*/
+void orderedListRangeReinsertTest(int num_of_keys, int num_of_rounds, int threads) {
+    lu::ordered_list_set<int> set;
+    for (int key = 0; key < num_of_keys; ++key) {
+        set.insert(key);
+    }
+    std::atomic<bool> done{};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < threads; ++i) {
+        readers.emplace_back([&set, &done] {
+            while (!done.load()) {
+                int prev = -1;
+                for (auto &value: set.guarded_range()) {
+                    if (value <= prev) {
+                        throw std::runtime_error("guarded range yielded " + std::to_string(value) + " after "
+                                                 + std::to_string(prev));
+                    }
+                    prev = value;
+                }
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int i = 0; i < threads; ++i) {
+        writers.emplace_back([&set, num_of_keys, num_of_rounds, i] {
+            std::mt19937 gen(i);
+            for (int j = 0; j < num_of_rounds; ++j) {
+                int key = static_cast<int>(gen() % num_of_keys);
+                if (set.erase(key)) {
+                    set.insert(key);
+                }
+            }
+        });
+    }
+    for (auto &writer: writers) {
+        writer.join();
+    }
+    done.store(true);
+    for (auto &reader: readers) {
+        reader.join();
+    }
+}
+
+/*
+  Eight threads insert and erase a handful of keys, so tall nodes are linked and unlinked under each other
+  all the time. Keys count their live copies, none may be left once the set is gone and the domain
+  cleaned up.
+*/
+void skipListStressTest(int num_of_keys, int actions) {
+    static constexpr int num_of_threads = 8;
+
+    struct CountedKey {
+        CountedKey(std::atomic<int> &alive, int key)
+            : alive(&alive)
+            , key(key) {
+            alive.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        CountedKey(const CountedKey &other)
+            : CountedKey(*other.alive, other.key) {}
+
+        ~CountedKey() {
+            alive->fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        bool operator<(const CountedKey &other) const noexcept {
+            return key < other.key;
+        }
+
+        std::atomic<int> *alive;
+        int key;
+    };
+
+    std::atomic<int> alive{};
+    {
+        lu::skip_list_set<CountedKey> set;
+        std::vector<std::thread> workers;
+        for (int i = 0; i < num_of_threads; ++i) {
+            workers.emplace_back([&set, &alive, num_of_keys, actions, i] {
+                std::mt19937 gen(i);
+                for (int j = 0; j < actions; ++j) {
+                    CountedKey key(alive, static_cast<int>(gen() % num_of_keys));
+                    if (gen() % 2) {
+                        set.insert(key);
+                    } else {
+                        set.erase(key);
+                    }
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+    checkAlive("skip list", alive);
+    checkReclamation("skip list", lu::get_default_domain());
+}
+
 template<class Set>
 class SetFixture {
     enum class OperationType : std::uint8_t { insert, erase, find };
@@ -323,6 +1040,24 @@ int main() {
     auto &&e_int_const = lu::get<int>((const decltype(ct) &) ct);
     auto &&e_int_rvalue_const = lu::get<int>(std::move((const decltype(ct) &) ct));
 
+    reclamationStressTest(200000, std::max(2u, std::thread::hardware_concurrency()));
+    retireBudgetTest(200000, std::max(2u, std::thread::hardware_concurrency()));
+    deferredDestructionTest(100000);
+    epochOwnedChainTest(100, 1000);
+    biasedRefCountTest(100000, std::max(2u, std::thread::hardware_concurrency()));
+    splitAtomicPointerTest(4, std::max(2u, std::thread::hardware_concurrency()));
+    loadGuardedTest(100000, std::max(2u, std::thread::hardware_concurrency()));
+    poolAllocatorTest(100000, std::max(2u, std::thread::hardware_concurrency()));
+    orderedListRangeTest(2000, std::max(2u, std::thread::hardware_concurrency()));
+    orderedListRangeReinsertTest(64, 200000, std::max(2u, std::thread::hardware_concurrency()));
+
+    SetFixture<lu::ordered_list_set<int>>({})(200000, std::max(2u, std::thread::hardware_concurrency()));
+    SetFixture<lu::concurrent_unordered_set<int>>({.num_of_keys = 10000})(
+            200000, std::max(2u, std::thread::hardware_concurrency()));
+    skipListStressTest(64, 1000000);
+    SetFixture<lu::skip_list_set<int>>({.num_of_keys = 10000})(200000,
+                                                                std::max(2u, std::thread::hardware_concurrency()));
+
     // for (int i = 0; i < 1000; ++i) {
     //     std::cout << "iteration: #" << i << std::endl;
     //     abstractStressTest(SetFixture<lu::ordered_list_set<int, lu::backoff<lu::none_backoff>>>({}));
@@ -1,9 +1,15 @@
 #ifndef __STRUCTURES_H__
 #define __STRUCTURES_H__
 
+#include "elimination_array.h"
+#include "epoch_domain.h"
+#include "hazard_era_domain.h"
 #include "shared_ptr.h"
 
+#include <cstddef>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 
 namespace lu {
@@ -113,6 +119,314 @@ private:
 }// namespace asp
 
 namespace hp {
+/*
+  With EliminationSize > 0 a push and a pop that fail their CAS try to meet in an elimination_array of that
+  many slots before backing off. Nodes are protected and retired in the domain given on construction.
+*/
+template<class ValueType, class BackOff, std::size_t EliminationSize = 0>
+class TreiberStack {
+    struct Node : public lu::compact_hazard_pointer_obj_base<Node> {
+        template<class... Args>
+        Node(Args &&...args)
+            : value(std::forward<Args>(args)...) {}
+
+        ValueType value;
+        Node *next{};
+    };
+
+    static constexpr bool is_eliminating = EliminationSize > 0;
+
+    struct NoElimination {};
+
+    using Elimination =
+            std::conditional_t<is_eliminating, lu::elimination_array<Node, EliminationSize>, NoElimination>;
+
+public:
+    explicit TreiberStack(lu::hazard_pointer_domain &domain = lu::get_default_domain())
+        : domain_(&domain) {}
+
+    ~TreiberStack() {
+        auto head = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next;
+            head->retire({}, *domain_);
+            head = next;
+        }
+    }
+
+    void push(ValueType value) {
+        BackOff back_off;
+        auto new_node = new Node(value);
+        auto head = head_.load();
+        new_node->next = head;
+        while (true) {
+            if (head_.compare_exchange_weak(new_node->next, new_node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return;
+            }
+            if constexpr (is_eliminating) {
+                if (elimination_.offer(new_node)) {
+                    return;
+                }
+            }
+            back_off();
+        }
+    }
+
+    std::optional<ValueType> pop() {
+        BackOff back_off;
+        auto head_guard = lu::make_hazard_pointer(*domain_);
+        while (true) {
+            auto head = head_guard.protect(head_);
+            if (!head) {
+                return std::nullopt;
+            }
+            if (head_.compare_exchange_strong(head, head->next, std::memory_order_relaxed)) {
+                head->retire({}, *domain_);
+                return {std::move(head->value)};
+            }
+            if constexpr (is_eliminating) {
+                if (auto node = elimination_.take()) {
+                    std::optional<ValueType> result(std::move(node->value));
+                    delete node;
+                    return result;
+                }
+            }
+            back_off();
+        }
+    }
+
+    /*
+      Takes the whole stack with one exchange, its nodes are retired as one batch.
+    */
+    template<class OutputIterator>
+    OutputIterator pop_all(OutputIterator out) {
+        auto head = head_.exchange(nullptr, std::memory_order_acquire);
+        std::vector<Node *> nodes;
+        for (; head; head = head->next) {
+            *out++ = std::move(head->value);
+            nodes.push_back(head);
+        }
+        Node::retire_batch(nodes.begin(), nodes.end(), {}, *domain_);
+        return out;
+    }
+
+private:
+    lu::hazard_pointer_domain *domain_;
+    std::atomic<Node *> head_{nullptr};
+    [[no_unique_address]] Elimination elimination_;
+};
+
+template<class ValueType, class BackOff>
+class MSQueue {
+    struct Node : lu::compact_hazard_pointer_obj_base<Node> {
+        ValueType value{};
+        std::atomic<Node *> next{};
+
+        Node() = default;
+
+        template<class... Args>
+        Node(Args &&...args)
+            : value(std::forward<Args>(args)...) {}
+    };
+
+public:
+    explicit MSQueue(lu::hazard_pointer_domain &domain = lu::get_default_domain())
+        : domain_(&domain) {
+        auto dummy_node = new Node();
+        head_.store(dummy_node);
+        tail_.store(dummy_node);
+    }
+
+    ~MSQueue() {
+        auto head = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next.load(std::memory_order_acquire);
+            head->retire({}, *domain_);
+            head = next;
+        }
+    }
+
+    template<class... Args>
+    void push(Args &&...args) {
+        BackOff back_off;
+
+        auto new_node = new Node(std::forward<Args>(args)...);
+        auto tail_guard = lu::make_hazard_pointer(*domain_);
+
+        while (true) {
+            auto tail = tail_guard.protect(tail_);
+            auto tail_next = tail->next.load();
+            if (tail_next) {
+                tail_.compare_exchange_weak(tail, tail_next);
+            } else {
+                if (tail->next.compare_exchange_weak(tail_next, new_node)) {
+                    tail_.compare_exchange_weak(tail, new_node);
+                    return;
+                }
+            }
+            back_off();
+        }
+    }
+
+    std::optional<ValueType> pop() {
+        BackOff back_off;
+        auto head_guard = lu::make_hazard_pointer(*domain_);
+        auto head_next_guard = lu::make_hazard_pointer(*domain_);
+        while (true) {
+            auto head = head_guard.protect(head_);
+            auto head_next = head_next_guard.protect(head->next);
+            if (!head_next) {
+                return std::nullopt;
+            }
+            if (head_.compare_exchange_weak(head, head_next)) {
+                head->retire({}, *domain_);
+                return {std::move(head_next->value)};
+            }
+            back_off();
+        }
+    }
+
+private:
+    lu::hazard_pointer_domain *domain_;
+    std::atomic<Node *> head_;
+    std::atomic<Node *> tail_;
+};
+
+}// namespace hp
+
+namespace ebr {
+template<class ValueType, class BackOff>
+class TreiberStack {
+    struct Node : public lu::compact_hazard_pointer_obj_base<Node> {
+        template<class... Args>
+        Node(Args &&...args)
+            : value(std::forward<Args>(args)...) {}
+
+        ValueType value;
+        Node *next{};
+    };
+
+public:
+    ~TreiberStack() {
+        auto head = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next;
+            head->retire({}, lu::get_default_epoch_domain());
+            head = next;
+        }
+    }
+
+    void push(ValueType value) {
+        BackOff back_off;
+        auto new_node = new Node(value);
+        auto head = head_.load();
+        new_node->next = head;
+        while (true) {
+            if (head_.compare_exchange_weak(new_node->next, new_node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return;
+            }
+            back_off();
+        }
+    }
+
+    std::optional<ValueType> pop() {
+        BackOff back_off;
+        auto guard = lu::make_epoch_guard();
+        while (true) {
+            auto head = head_.load(std::memory_order_acquire);
+            if (!head) {
+                return std::nullopt;
+            }
+            if (head_.compare_exchange_strong(head, head->next, std::memory_order_relaxed)) {
+                head->retire({}, lu::get_default_epoch_domain());
+                return {std::move(head->value)};
+            }
+            back_off();
+        }
+    }
+
+private:
+    std::atomic<Node *> head_{nullptr};
+};
+
+template<class ValueType, class BackOff>
+class MSQueue {
+    struct Node : lu::compact_hazard_pointer_obj_base<Node> {
+        ValueType value{};
+        std::atomic<Node *> next{};
+
+        Node() = default;
+
+        template<class... Args>
+        Node(Args &&...args)
+            : value(std::forward<Args>(args)...) {}
+    };
+
+public:
+    MSQueue() {
+        auto dummy_node = new Node();
+        head_.store(dummy_node);
+        tail_.store(dummy_node);
+    }
+
+    ~MSQueue() {
+        auto head = head_.load(std::memory_order_acquire);
+        while (head) {
+            auto next = head->next.load(std::memory_order_acquire);
+            head->retire({}, lu::get_default_epoch_domain());
+            head = next;
+        }
+    }
+
+    template<class... Args>
+    void push(Args &&...args) {
+        BackOff back_off;
+
+        auto new_node = new Node(std::forward<Args>(args)...);
+        auto guard = lu::make_epoch_guard();
+
+        while (true) {
+            auto tail = tail_.load();
+            auto tail_next = tail->next.load();
+            if (tail_next) {
+                tail_.compare_exchange_weak(tail, tail_next);
+            } else {
+                if (tail->next.compare_exchange_weak(tail_next, new_node)) {
+                    tail_.compare_exchange_weak(tail, new_node);
+                    return;
+                }
+            }
+            back_off();
+        }
+    }
+
+    std::optional<ValueType> pop() {
+        BackOff back_off;
+        auto guard = lu::make_epoch_guard();
+        while (true) {
+            auto head = head_.load();
+            auto head_next = head->next.load();
+            if (!head_next) {
+                return std::nullopt;
+            }
+            if (head_.compare_exchange_weak(head, head_next)) {
+                head->retire({}, lu::get_default_epoch_domain());
+                return {std::move(head_next->value)};
+            }
+            back_off();
+        }
+    }
+
+private:
+    std::atomic<Node *> head_;
+    std::atomic<Node *> tail_;
+};
+
+}// namespace ebr
+
+namespace he {
 template<class ValueType, class BackOff>
 class TreiberStack {
     struct Node : public lu::hazard_pointer_obj_base<Node> {
@@ -129,7 +443,7 @@ public:
         auto head = head_.load(std::memory_order_acquire);
         while (head) {
             auto next = head->next;
-            head->retire();
+            head->retire({}, lu::get_default_era_domain());
             head = next;
         }
     }
@@ -150,14 +464,14 @@ public:
 
     std::optional<ValueType> pop() {
         BackOff back_off;
-        auto head_guard = lu::make_hazard_pointer();
+        auto head_guard = lu::make_hazard_era();
         while (true) {
             auto head = head_guard.protect(head_);
             if (!head) {
                 return std::nullopt;
             }
             if (head_.compare_exchange_strong(head, head->next, std::memory_order_relaxed)) {
-                head->retire();
+                head->retire({}, lu::get_default_era_domain());
                 return {std::move(head->value)};
             }
             back_off();
@@ -192,7 +506,7 @@ public:
         auto head = head_.load(std::memory_order_acquire);
         while (head) {
             auto next = head->next.load(std::memory_order_acquire);
-            head->retire();
+            head->retire({}, lu::get_default_era_domain());
             head = next;
         }
     }
@@ -202,7 +516,7 @@ public:
         BackOff back_off;
 
         auto new_node = new Node(std::forward<Args>(args)...);
-        auto tail_guard = lu::make_hazard_pointer();
+        auto tail_guard = lu::make_hazard_era();
 
         while (true) {
             auto tail = tail_guard.protect(tail_);
@@ -221,8 +535,8 @@ public:
 
     std::optional<ValueType> pop() {
         BackOff back_off;
-        auto head_guard = lu::make_hazard_pointer();
-        auto head_next_guard = lu::make_hazard_pointer();
+        auto head_guard = lu::make_hazard_era();
+        auto head_next_guard = lu::make_hazard_era();
         while (true) {
             auto head = head_guard.protect(head_);
             auto head_next = head_next_guard.protect(head->next);
@@ -230,7 +544,7 @@ public:
                 return std::nullopt;
             }
             if (head_.compare_exchange_weak(head, head_next)) {
-                head->retire();
+                head->retire({}, lu::get_default_era_domain());
                 return {std::move(head_next->value)};
             }
             back_off();
@@ -242,7 +556,7 @@ private:
     std::atomic<Node *> tail_;
 };
 
-}// namespace hp
+}// namespace he
 }// namespace lu
 
 #endif
\ No newline at end of file